@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Grass/GrassRuleTable.h"
+
+#include "LandscapeGrassType.h"
+#include "LandscapeGroundTypeData.h"
+#include "RuntimeLandscape.h"
+#include "RuntimeLandscapeKernels.h"
+#include "Threads/GenerateAdditionalVertexDataWorker.h"
+
+void FGrassRuleTable::Build(TConstArrayView<const ULandscapeGroundTypeData*> GroundTypesByPlane,
+                            TConstArrayView<FHeightBasedLandscapeData> HeightBasedData)
+{
+	Rules.Reset(GroundTypesByPlane.Num() + HeightBasedData.Num());
+	HeightBands.Reset(HeightBasedData.Num());
+	PlaneAmount = GroundTypesByPlane.Num();
+
+	for (const ULandscapeGroundTypeData* GroundType : GroundTypesByPlane)
+	{
+		Rules.Add(GroundType ? CompileRule(GroundType->GrassTypeSettings) : FGrassRule());
+	}
+
+	// the last matching height band used to win, so check them in reverse order
+	for (int32 i = HeightBasedData.Num() - 1; i >= 0; --i)
+	{
+		const FHeightBasedLandscapeData& Data = HeightBasedData[i];
+		HeightBands.Add({Data.MinHeight, Data.MaxHeight, Rules.Add(CompileRule(Data.Grass))});
+	}
+}
+
+uint32 FGrassRuleTable::CalculateHash() const
+{
+	uint32 Result = GetTypeHash(PlaneAmount);
+	for (const FGrassRule& Rule : Rules)
+	{
+		Result = HashCombine(Result, GetTypeHash(Rule.MinNormalZ));
+		if (!Rule.GrassType)
+		{
+			continue;
+		}
+
+		// object paths are used instead of pointers, since pointers change between sessions
+		Result = HashCombine(Result, GetTypeHash(Rule.GrassType->GetPathName()));
+		for (const FGrassVariety& Variety : Rule.GrassType->GrassVarieties)
+		{
+			// hash the settings in the form the grass worker places them with, so no placement setting is missed
+			Result = HashCombine(Result, GetTypeHash(GetPathNameSafe(Variety.GrassMesh)));
+			Result = HashCombine(Result, GetTypeHash(FGenerateAdditionalVertexDataWorker::MakeKernelVariety(Variety)));
+		}
+	}
+
+	for (const FHeightBand& HeightBand : HeightBands)
+	{
+		Result = HashCombine(Result, GetTypeHash(HeightBand.MinHeight));
+		Result = HashCombine(Result, GetTypeHash(HeightBand.MaxHeight));
+		Result = HashCombine(Result, GetTypeHash(HeightBand.Rule));
+	}
+
+	return Result;
+}
+
+FGrassRule FGrassRuleTable::CompileRule(const FGrassTypeSettings& Settings)
+{
+	FGrassRule Result;
+	Result.GrassType = Settings.GrassType;
+	if (Settings.MaxSlopeAngle > 0.0f)
+	{
+		Result.MinNormalZ = FMath::Cos(FMath::DegreesToRadians(Settings.MaxSlopeAngle));
+	}
+
+	return Result;
+}
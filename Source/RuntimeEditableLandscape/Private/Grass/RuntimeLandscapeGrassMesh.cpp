@@ -0,0 +1,298 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Grass/RuntimeLandscapeGrassMesh.h"
+
+#include "LandscapeGrassType.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Threads/RuntimeLandscapeRebuildManager.h"
+
+/** Free slots are only compacted if there are at least this many */
+static constexpr int32 MinFreeSlotsForCompaction = 256;
+
+int32 FRuntimeLandscapeGrassMesh::UpdateInstances(TConstArrayView<FTransform> Transforms,
+                                                  TConstArrayView<int32> TransformVertices, int32 VertexAmount)
+{
+	return UpdateInstancesInArea(Transforms, TransformVertices, VertexAmount, FIntRect(0, 0, VertexAmount, 1));
+}
+
+int32 FRuntimeLandscapeGrassMesh::UpdateInstancesInArea(TConstArrayView<FTransform> Transforms,
+                                                        TConstArrayView<int32> TransformVertices, int32 RowLength,
+                                                        const FIntRect& Area)
+{
+	check(InstancedMesh);
+	check(Transforms.Num() == TransformVertices.Num());
+
+	// nothing to diff against (i.e. after creation or load)
+	if (SlotVertices.IsEmpty())
+	{
+		ResetInstances(Transforms, TransformVertices);
+		return Transforms.Num();
+	}
+
+	// sort the used slots of the area by vertex, slots outside of the area are not touched
+	const int32 AreaWidth = Area.Width();
+	const int32 AreaVertexAmount = Area.Area();
+	auto GetAreaIndex = [&Area, AreaWidth, RowLength](int32 Vertex)
+	{
+		const FIntPoint Coordinates(Vertex % RowLength, Vertex / RowLength);
+		return Area.Contains(Coordinates)
+			       ? Coordinates.X - Area.Min.X + (Coordinates.Y - Area.Min.Y) * AreaWidth
+			       : INDEX_NONE;
+	};
+
+	TArray<int32> SlotAreaIndices;
+	SlotAreaIndices.SetNumUninitialized(SlotVertices.Num());
+	TArray<int32> OldOffsets;
+	OldOffsets.SetNumZeroed(AreaVertexAmount + 1);
+	for (int32 Slot = 0; Slot < SlotVertices.Num(); ++Slot)
+	{
+		SlotAreaIndices[Slot] = SlotVertices[Slot] == INDEX_NONE ? INDEX_NONE : GetAreaIndex(SlotVertices[Slot]);
+		if (SlotAreaIndices[Slot] != INDEX_NONE)
+		{
+			++OldOffsets[SlotAreaIndices[Slot] + 1];
+		}
+	}
+
+	for (int32 AreaIndex = 1; AreaIndex <= AreaVertexAmount; ++AreaIndex)
+	{
+		OldOffsets[AreaIndex] += OldOffsets[AreaIndex - 1];
+	}
+
+	TArray<int32> OldSlots;
+	OldSlots.SetNumUninitialized(OldOffsets[AreaVertexAmount]);
+	{
+		TArray<int32> Cursors(OldOffsets.GetData(), AreaVertexAmount);
+		for (int32 Slot = 0; Slot < SlotVertices.Num(); ++Slot)
+		{
+			if (SlotAreaIndices[Slot] != INDEX_NONE)
+			{
+				OldSlots[Cursors[SlotAreaIndices[Slot]]++] = Slot;
+			}
+		}
+	}
+
+	// compare old and new instances of every vertex
+	TArray<int32> ChangedSlots;
+	TArray<int32> FreedSlots;
+	TArray<int32> AddedInstances;
+	int32 NewIndex = 0;
+	for (int32 AreaIndex = 0; AreaIndex < AreaVertexAmount; ++AreaIndex)
+	{
+		const int32 Vertex = Area.Min.X + AreaIndex % AreaWidth + (Area.Min.Y + AreaIndex / AreaWidth) * RowLength;
+		const int32 NewStart = NewIndex;
+		while (NewIndex < TransformVertices.Num() && TransformVertices[NewIndex] == Vertex)
+		{
+			++NewIndex;
+		}
+
+		const int32 NewCount = NewIndex - NewStart;
+		const int32 OldStart = OldOffsets[AreaIndex];
+		const int32 OldCount = OldOffsets[AreaIndex + 1] - OldStart;
+		const int32 SharedCount = FMath::Min(NewCount, OldCount);
+
+		for (int32 i = 0; i < SharedCount; ++i)
+		{
+			const int32 Slot = OldSlots[OldStart + i];
+			if (!SlotTransforms[Slot].Equals(Transforms[NewStart + i]))
+			{
+				SlotTransforms[Slot] = Transforms[NewStart + i];
+				ChangedSlots.Add(Slot);
+			}
+		}
+
+		for (int32 i = SharedCount; i < OldCount; ++i)
+		{
+			const int32 Slot = OldSlots[OldStart + i];
+			SlotVertices[Slot] = INDEX_NONE;
+			FreedSlots.Add(Slot);
+		}
+
+		for (int32 i = SharedCount; i < NewCount; ++i)
+		{
+			AddedInstances.Add(NewStart + i);
+		}
+	}
+
+	checkf(NewIndex == Transforms.Num(), TEXT("Grass instances have to be sorted by vertex and inside the area!"));
+
+	const int32 ChangedInstanceAmount = ChangedSlots.Num() + FreedSlots.Num() + AddedInstances.Num();
+
+	// get rid of the free slots if too many accumulated, the instances outside of the area are kept
+	const int32 FreeSlotAmount = FreeSlots.Num() + FreedSlots.Num() - AddedInstances.Num();
+	if (FreeSlotAmount > MinFreeSlotsForCompaction && FreeSlotAmount * 2 > SlotVertices.Num())
+	{
+		TArray<FTransform> CompactedTransforms;
+		TArray<int32> CompactedVertices;
+		CompactedTransforms.Reserve(SlotVertices.Num() - FreeSlotAmount);
+		CompactedVertices.Reserve(SlotVertices.Num() - FreeSlotAmount);
+		for (int32 Slot = 0; Slot < SlotVertices.Num(); ++Slot)
+		{
+			if (SlotVertices[Slot] != INDEX_NONE)
+			{
+				CompactedTransforms.Add(SlotTransforms[Slot]);
+				CompactedVertices.Add(SlotVertices[Slot]);
+			}
+		}
+
+		for (const int32 InstanceIndex : AddedInstances)
+		{
+			CompactedTransforms.Add(Transforms[InstanceIndex]);
+			CompactedVertices.Add(TransformVertices[InstanceIndex]);
+		}
+
+		ResetInstances(CompactedTransforms, CompactedVertices);
+		return CompactedTransforms.Num();
+	}
+
+	FreeSlots.Append(FreedSlots);
+
+	// reuse free slots before adding new instances
+	TArray<FTransform> AppendedTransforms;
+	for (const int32 InstanceIndex : AddedInstances)
+	{
+		if (FreeSlots.IsEmpty() == false)
+		{
+			const int32 Slot = FreeSlots.Pop(false);
+			SlotVertices[Slot] = TransformVertices[InstanceIndex];
+			SlotTransforms[Slot] = Transforms[InstanceIndex];
+			ChangedSlots.Add(Slot);
+		}
+		else
+		{
+			SlotVertices.Add(TransformVertices[InstanceIndex]);
+			SlotTransforms.Add(Transforms[InstanceIndex]);
+			AppendedTransforms.Add(Transforms[InstanceIndex]);
+		}
+	}
+
+	// hide slots that were freed and not reused
+	for (const int32 Slot : FreedSlots)
+	{
+		if (SlotVertices[Slot] == INDEX_NONE)
+		{
+			SlotTransforms[Slot].SetScale3D(FVector::ZeroVector);
+			ChangedSlots.Add(Slot);
+		}
+	}
+
+	FlushSlotUpdates(ChangedSlots);
+	if (AppendedTransforms.IsEmpty() == false)
+	{
+		InstancedMesh->AddInstances(AppendedTransforms, false);
+	}
+
+	return ChangedInstanceAmount;
+}
+
+int32 FRuntimeLandscapeGrassMesh::FindOrAdd(TArray<FRuntimeLandscapeGrassMesh>& GrassMeshes,
+                                            const FGrassVariety& Variety, USceneComponent* AttachParent)
+{
+	const int32 GrassMeshIndex = GrassMeshes.IndexOfByPredicate([&Variety](const FRuntimeLandscapeGrassMesh& Current)
+	{
+		return Current.InstancedMesh && Current.InstancedMesh->GetStaticMesh() == Variety.GrassMesh;
+	});
+
+	if (GrassMeshIndex != INDEX_NONE)
+	{
+		return GrassMeshIndex;
+	}
+
+	UHierarchicalInstancedStaticMeshComponent* InstancedStaticMesh = NewObject<
+		UHierarchicalInstancedStaticMeshComponent>(AttachParent->GetOwner());
+	InstancedStaticMesh->SetStaticMesh(Variety.GrassMesh);
+	InstancedStaticMesh->AttachToComponent(AttachParent, FAttachmentTransformRules::SnapToTargetIncludingScale);
+	InstancedStaticMesh->RegisterComponent();
+
+	const int32 Result = GrassMeshes.AddDefaulted();
+	GrassMeshes[Result].InstancedMesh = InstancedStaticMesh;
+	return Result;
+}
+
+bool FRuntimeLandscapeGrassMesh::NeedsFullRebuild(int32 NewInstanceAmount) const
+{
+	if (SlotVertices.IsEmpty())
+	{
+		return true;
+	}
+
+	// at least this many slots will be free after the update, so compaction is certain
+	const int32 MinFreeSlotAmount = FreeSlots.Num() + FMath::Max(0, GetUsedInstanceAmount() - NewInstanceAmount);
+	return MinFreeSlotAmount > MinFreeSlotsForCompaction && MinFreeSlotAmount * 2 > SlotVertices.Num();
+}
+
+void FRuntimeLandscapeGrassMesh::AcceptPrebuiltTree(FLandscapeGrassTree& GrassTree)
+{
+	check(InstancedMesh);
+	check(GrassTree.InstanceData.Num() == GrassTree.SortedVertices.Num());
+
+	SlotVertices = MoveTemp(GrassTree.SortedVertices);
+	SlotTransforms = MoveTemp(GrassTree.SortedTransforms);
+	FreeSlots.Empty();
+
+	InstancedMesh->ClearInstances();
+	InstancedMesh->AcceptPrebuiltTree(GrassTree.InstanceData, GrassTree.ClusterTree, GrassTree.OcclusionLayerNum,
+	                                  SlotVertices.Num());
+}
+
+void FRuntimeLandscapeGrassMesh::ClearInstances()
+{
+	SlotVertices.Empty();
+	SlotTransforms.Empty();
+	FreeSlots.Empty();
+	InstancedMesh->ClearInstances();
+}
+
+void FRuntimeLandscapeGrassMesh::ApplyVarietySettings(const FGrassVariety& Variety) const
+{
+	InstancedMesh->SetCullDistances(Variety.GetStartCullDistance(), Variety.GetEndCullDistance());
+	InstancedMesh->SetCastShadow(Variety.bCastDynamicShadow);
+	InstancedMesh->SetCastContactShadow(Variety.bCastContactShadow);
+}
+
+void FRuntimeLandscapeGrassMesh::ResetInstances(TConstArrayView<FTransform> Transforms,
+                                                TConstArrayView<int32> TransformVertices)
+{
+	SlotVertices.Reset();
+	SlotVertices.Append(TransformVertices.GetData(), TransformVertices.Num());
+	SlotTransforms.Reset();
+	SlotTransforms.Append(Transforms.GetData(), Transforms.Num());
+	FreeSlots.Empty();
+
+	InstancedMesh->ClearInstances();
+	if (SlotTransforms.IsEmpty() == false)
+	{
+		InstancedMesh->AddInstances(SlotTransforms, false);
+	}
+}
+
+void FRuntimeLandscapeGrassMesh::FlushSlotUpdates(TArray<int32>& ChangedSlots) const
+{
+	if (ChangedSlots.IsEmpty())
+	{
+		return;
+	}
+
+	ChangedSlots.Sort();
+
+	TArray<FTransform> BatchTransforms;
+	int32 BatchStart = ChangedSlots[0];
+	for (int32 i = 0; i < ChangedSlots.Num(); ++i)
+	{
+		const int32 Slot = ChangedSlots[i];
+		BatchTransforms.Add(SlotTransforms[Slot]);
+
+		const bool bIsLastInBatch = i == ChangedSlots.Num() - 1 || ChangedSlots[i + 1] != Slot + 1;
+		if (bIsLastInBatch)
+		{
+			InstancedMesh->BatchUpdateInstancesTransforms(BatchStart, BatchTransforms, false, false, true);
+			BatchTransforms.Reset();
+			if (i < ChangedSlots.Num() - 1)
+			{
+				BatchStart = ChangedSlots[i + 1];
+			}
+		}
+	}
+
+	InstancedMesh->MarkRenderStateDirty();
+}
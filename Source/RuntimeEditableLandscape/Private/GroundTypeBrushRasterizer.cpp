@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GroundTypeBrushRasterizer.h"
+
+#include "LandscapeLayerComponent.h"
+
+FGroundTypeBrushRasterizer::FGroundTypeBrushRasterizer(ELayerShape InShape, const FTransform& BrushTransform,
+                                                       const FVector2D& InExtent, float InFalloff)
+{
+	Shape = InShape;
+	Center = FVector2D(BrushTransform.GetLocation());
+	Extent = FVector2D(FMath::Max(InExtent.X, UE_KINDA_SMALL_NUMBER), FMath::Max(InExtent.Y, UE_KINDA_SMALL_NUMBER));
+	Falloff = FMath::Max(InFalloff, 0.0f);
+	FMath::SinCos(&YawSin, &YawCos, FMath::DegreesToRadians(BrushTransform.GetRotation().Rotator().Yaw));
+}
+
+FIntRect FGroundTypeBrushRasterizer::GetAffectedVertexRect(const FVector2D& GridOrigin, float VertexDistance,
+                                                           const FIntPoint& GridSize) const
+{
+	// axis aligned extent of the rotated brush
+	const FVector2D RotatedExtent(FMath::Abs(YawCos) * Extent.X + FMath::Abs(YawSin) * Extent.Y,
+	                              FMath::Abs(YawSin) * Extent.X + FMath::Abs(YawCos) * Extent.Y);
+	const FVector2D Min = (Center - RotatedExtent - GridOrigin) / VertexDistance;
+	const FVector2D Max = (Center + RotatedExtent - GridOrigin) / VertexDistance;
+
+	return FIntRect(FMath::Clamp(FMath::FloorToInt(Min.X), 0, GridSize.X),
+	                FMath::Clamp(FMath::FloorToInt(Min.Y), 0, GridSize.Y),
+	                FMath::Clamp(FMath::CeilToInt(Max.X) + 1, 0, GridSize.X),
+	                FMath::Clamp(FMath::CeilToInt(Max.Y) + 1, 0, GridSize.Y));
+}
+
+float FGroundTypeBrushRasterizer::GetStrength(const FVector2D& WorldLocation) const
+{
+	// transform into brush space
+	const FVector2D Offset = WorldLocation - Center;
+	const FVector2D Local(Offset.X * YawCos + Offset.Y * YawSin, Offset.Y * YawCos - Offset.X * YawSin);
+
+	float DistanceToEdge;
+	if (Shape == ELayerShape::HS_Round)
+	{
+		const float NormalizedDistance = FMath::Sqrt(
+			FMath::Square(Local.X / Extent.X) + FMath::Square(Local.Y / Extent.Y));
+		DistanceToEdge = (1.0f - NormalizedDistance) * FMath::Min(Extent.X, Extent.Y);
+	}
+	else
+	{
+		DistanceToEdge = FMath::Min(Extent.X - FMath::Abs(Local.X), Extent.Y - FMath::Abs(Local.Y));
+	}
+
+	if (DistanceToEdge < 0.0f)
+	{
+		return 0.0f;
+	}
+
+	if (Falloff <= 0.0f)
+	{
+		return 1.0f;
+	}
+
+	return FMath::Min(DistanceToEdge / Falloff, 1.0f);
+}
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GroundTypeWeightTile.h"
+
+TArray<uint8>& FGroundTypeWeightTile::GetOrAllocatePlane(int32 Plane, int32 VertexAmount)
+{
+	if (Planes.Num() <= Plane)
+	{
+		Planes.SetNum(Plane + 1);
+	}
+
+	TArray<uint8>& Weights = Planes[Plane].Weights;
+	if (Weights.IsEmpty())
+	{
+		Weights.SetNumZeroed(VertexAmount);
+	}
+
+	check(Weights.Num() == VertexAmount);
+	return Weights;
+}
+
+void FGroundTypeWeightTile::ReleaseEmptyPlanes()
+{
+	for (FGroundTypeWeightPlane& Plane : Planes)
+	{
+		if (Plane.Weights.IsEmpty() == false && !Plane.Weights.ContainsByPredicate([](uint8 Weight)
+		{
+			return Weight > 0;
+		}))
+		{
+			Plane.Weights.Empty();
+		}
+	}
+
+	// trailing planes are not required
+	while (Planes.IsEmpty() == false && Planes.Last().Weights.IsEmpty())
+	{
+		Planes.Pop();
+	}
+}
+
+void FGroundTypeWeightTile::UpdateDominantPlanes(int32 VertexAmount)
+{
+	if (Planes.IsEmpty())
+	{
+		DominantPlanes.Empty();
+		return;
+	}
+
+	check(Planes.Num() <= MAX_GROUND_TYPE_PLANES);
+	DominantPlanes.Init(GROUND_TYPE_PLANE_NONE, VertexAmount);
+	TArray<uint8> HighestWeights;
+	HighestWeights.SetNumZeroed(VertexAmount);
+
+	// on equal weights, the last plane wins
+	for (int32 Plane = 0; Plane < Planes.Num(); ++Plane)
+	{
+		const TArray<uint8>& Weights = Planes[Plane].Weights;
+		if (Weights.IsEmpty())
+		{
+			continue;
+		}
+
+		for (int32 VertexIndex = 0; VertexIndex < VertexAmount; ++VertexIndex)
+		{
+			if (Weights[VertexIndex] > 0 && Weights[VertexIndex] >= HighestWeights[VertexIndex])
+			{
+				HighestWeights[VertexIndex] = Weights[VertexIndex];
+				DominantPlanes[VertexIndex] = Plane;
+			}
+		}
+	}
+}
+
+SIZE_T FGroundTypeWeightTile::GetAllocatedSize() const
+{
+	SIZE_T Result = Planes.GetAllocatedSize() + DominantPlanes.GetAllocatedSize();
+	for (const FGroundTypeWeightPlane& Plane : Planes)
+	{
+		Result += Plane.Weights.GetAllocatedSize();
+	}
+
+	return Result;
+}
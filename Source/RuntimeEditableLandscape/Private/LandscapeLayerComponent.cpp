@@ -5,7 +5,8 @@
 
 #include "RuntimeLandscape.h"
 #include "RuntimeLandscapeComponent.h"
-#include "Kismet/GameplayStatics.h"
+#include "RuntimeLandscapeKernels.h"
+#include "RuntimeLandscapeSubsystem.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "LayerTypes/LandscapeLayerDataBase.h"
 
@@ -169,51 +170,69 @@ bool ULandscapeLayerComponent::TryCalculateBoxSmoothingFactor(float& OutSmoothin
 		BoundsComponent ? BoundsComponent->GetComponentTransform() : GetOwner()->GetActorTransform(),
 		FVector(Location, 0.0f));
 
-	const float DistanceSqr = InnerBox.ComputeSquaredDistanceToPoint(FVector2D(RotatedLocation) + Origin);
-	const float SmoothingDistanceSqr = FMath::Square(SmoothingDistance);
-	if (DistanceSqr >= SmoothingDistanceSqr)
-	{
-		return false;
-	}
-
-	OutSmoothingFactor = DistanceSqr == 0.0f ? 0.0f : DistanceSqr / SmoothingDistanceSqr;
-	return true;
+	return RuntimeLandscapeKernels::TryCalculateBoxSmoothingFactor(InnerBox, SmoothingDistance,
+	                                                               FVector2D(RotatedLocation) + Origin,
+	                                                               OutSmoothingFactor);
 }
 
 bool ULandscapeLayerComponent::TryCalculateSphereSmoothingFactor(float& OutSmoothingFactor, const FVector2D& Location,
                                                                  FVector2D Origin) const
 {
-	const float OuterRadiusSquared = FMath::Square(Radius + BoundsSmoothingOffset);
-	const float DistanceSqr = (Location - Origin).SizeSquared();
-	if (DistanceSqr >= OuterRadiusSquared)
+	return RuntimeLandscapeKernels::TryCalculateRoundSmoothingFactor(Origin, Radius, InnerSmoothingOffset,
+	                                                                 BoundsSmoothingOffset, SmoothingDistance, Location,
+	                                                                 OutSmoothingFactor);
+}
+
+void ULandscapeLayerComponent::HandleBoundsChanged(USceneComponent* SceneComponent,
+                                                   EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	UpdateShape();
+
+	// the layer might have moved onto other landscapes
+	const TSet<TObjectPtr<ARuntimeLandscape>> PreviousLandscapes = AffectedLandscapes;
+	if (bResolveAffectedLandscapes)
 	{
-		return false;
+		ResolveAffectedLandscapes();
 	}
 
-	const float InnerRadiusSqr = FMath::Square(Radius - InnerSmoothingOffset);
-	if (DistanceSqr < InnerRadiusSqr)
+	// removing and adding the layer again is measured as a single edit of every landscape
+	TArray<FRuntimeLandscapeEditScope, TInlineAllocator<2>> EditScopes;
+	for (ARuntimeLandscape* Landscape : PreviousLandscapes.Union(AffectedLandscapes))
 	{
-		OutSmoothingFactor = 0.0f;
+		if (Landscape)
+		{
+			EditScopes.Emplace(*Landscape, ERuntimeLandscapeEditType::MoveLayer);
+		}
 	}
-	else
+
+	for (ARuntimeLandscape* PreviousLandscape : PreviousLandscapes)
 	{
-		check(SmoothingDistance > 0.0f);
-		const float Distance = FMath::Abs(FMath::Sqrt(DistanceSqr) - (Radius - InnerSmoothingOffset));
-		OutSmoothingFactor = Distance / SmoothingDistance;
-		check(OutSmoothingFactor >= 0.0f && OutSmoothingFactor <= 1.0f);
+		if (PreviousLandscape)
+		{
+			PreviousLandscape->RemoveLandscapeLayer(this);
+		}
 	}
 
-	return true;
+	for (ARuntimeLandscape* AffectedLandscape : AffectedLandscapes)
+	{
+		AffectedLandscape->AddLandscapeLayer(this);
+	}
 }
 
-void ULandscapeLayerComponent::HandleBoundsChanged(USceneComponent* SceneComponent,
-                                                   EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+void ULandscapeLayerComponent::ResolveAffectedLandscapes()
 {
-	UpdateShape();
-	for (ARuntimeLandscape* AffectedLandscape : AffectedLandscapes)
+	AffectedLandscapes.Reset();
+	const URuntimeLandscapeSubsystem* Subsystem = GetWorld()->GetSubsystem<URuntimeLandscapeSubsystem>();
+	if (!ensure(Subsystem))
 	{
-		AffectedLandscape->RemoveLandscapeLayer(this);
-		AffectedLandscape->AddLandscapeLayer(this);
+		return;
+	}
+
+	TArray<ARuntimeLandscape*> Landscapes;
+	Subsystem->GetLandscapesInArea(GetBoundingBox(), Landscapes);
+	for (ARuntimeLandscape* Landscape : Landscapes)
+	{
+		AffectedLandscapes.Add(Landscape);
 	}
 }
 
@@ -236,15 +255,10 @@ void ULandscapeLayerComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// ...	
 	if (AffectedLandscapes.IsEmpty())
 	{
-		TArray<AActor*> LandscapeActors;
-		UGameplayStatics::GetAllActorsOfClass(GetWorld(), ARuntimeLandscape::StaticClass(), LandscapeActors);
-		for (AActor* LandscapeActor : LandscapeActors)
-		{
-			AffectedLandscapes.Add(Cast<ARuntimeLandscape>(LandscapeActor));
-		}
+		bResolveAffectedLandscapes = true;
+		ResolveAffectedLandscapes();
 	}
 
 	if (!bWaitForActivation)
@@ -20,6 +20,7 @@ void ULandscapeGroundTypeLayerData::ApplyToLandscape(ARuntimeLandscape* Landscap
 
 		const FTransform& WorldTransform = LandscapeLayerComponent->GetOwner()->GetActorTransform();
 		
-		Landscape->DrawGroundType(GroundType, Shape, WorldTransform, BoxExtent);
+		Landscape->DrawGroundType(GroundType, Shape, WorldTransform, BoxExtent,
+		                          LandscapeLayerComponent->SmoothingDistance);
 	}
 }
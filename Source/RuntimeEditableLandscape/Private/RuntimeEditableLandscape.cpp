@@ -2,19 +2,159 @@
 
 #include "RuntimeEditableLandscape.h"
 
+#include "Misc/CoreDelegates.h"
+
 #define LOCTEXT_NAMESPACE "FRuntimeEditableLandscapeModule"
 
 DEFINE_LOG_CATEGORY(RuntimeEditableLandscape);
+CSV_DEFINE_CATEGORY(RuntimeLandscape, true);
+
+TStaticArray<std::atomic<int64>, static_cast<int32>(ERuntimeLandscapeMemory::Num)>
+FRuntimeEditableLandscapeModule::TrackedMemory(InPlace, 0);
+std::atomic<int32> FRuntimeEditableLandscapeModule::QueuedRebuilds = 0;
+std::atomic<int32> FRuntimeEditableLandscapeModule::RebuildsInFlight = 0;
+std::atomic<bool> FRuntimeEditableLandscapeModule::bStageTimingsEnabled = false;
+TStaticArray<std::atomic<uint64>, static_cast<int32>(ERuntimeLandscapeStage::Num)>
+FRuntimeEditableLandscapeModule::StageCycles(InPlace, 0);
+TStaticArray<std::atomic<int64>, static_cast<int32>(ERuntimeLandscapeStage::Num)>
+FRuntimeEditableLandscapeModule::StageCalls(InPlace, 0);
 
 void FRuntimeEditableLandscapeModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&FRuntimeEditableLandscapeModule::RecordCsvStats);
 }
 
 void FRuntimeEditableLandscapeModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+}
+
+void FRuntimeEditableLandscapeModule::TrackMemory(ERuntimeLandscapeMemory Type, int64 Delta)
+{
+	if (Delta == 0)
+	{
+		return;
+	}
+
+	TrackedMemory[static_cast<int32>(Type)].fetch_add(Delta, std::memory_order_relaxed);
+#if STATS
+	FName StatName;
+	switch (Type)
+	{
+	case ERuntimeLandscapeMemory::Heights:
+		StatName = GET_STATFNAME(STAT_RuntimeLandscapeHeightsMemory);
+		break;
+	case ERuntimeLandscapeMemory::GroundTypeWeights:
+		StatName = GET_STATFNAME(STAT_RuntimeLandscapeGroundTypeWeightsMemory);
+		break;
+	case ERuntimeLandscapeMemory::Grass:
+		StatName = GET_STATFNAME(STAT_RuntimeLandscapeGrassMemory);
+		break;
+	case ERuntimeLandscapeMemory::RebuildBuffers:
+		StatName = GET_STATFNAME(STAT_RuntimeLandscapeRebuildBuffersMemory);
+		break;
+	default:
+		checkNoEntry();
+		return;
+	}
+
+	// the stat messages expect positive amounts
+	if (Delta > 0)
+	{
+		INC_MEMORY_STAT_BY_FName(StatName, Delta);
+	}
+	else
+	{
+		DEC_MEMORY_STAT_BY_FName(StatName, -Delta);
+	}
+#endif
+}
+
+void FRuntimeEditableLandscapeModule::TrackRebuilds(int32 QueuedDelta, int32 InFlightDelta)
+{
+	QueuedRebuilds.fetch_add(QueuedDelta, std::memory_order_relaxed);
+	RebuildsInFlight.fetch_add(InFlightDelta, std::memory_order_relaxed);
+	if (QueuedDelta > 0)
+	{
+		INC_DWORD_STAT_BY(STAT_RuntimeLandscapeQueuedRebuilds, QueuedDelta);
+	}
+	else if (QueuedDelta < 0)
+	{
+		DEC_DWORD_STAT_BY(STAT_RuntimeLandscapeQueuedRebuilds, -QueuedDelta);
+	}
+
+	if (InFlightDelta > 0)
+	{
+		INC_DWORD_STAT_BY(STAT_RuntimeLandscapeActiveRebuilds, InFlightDelta);
+	}
+	else if (InFlightDelta < 0)
+	{
+		DEC_DWORD_STAT_BY(STAT_RuntimeLandscapeActiveRebuilds, -InFlightDelta);
+	}
+}
+
+void FRuntimeEditableLandscapeModule::SetStageTimingsEnabled(bool bEnabled)
+{
+	bStageTimingsEnabled.store(bEnabled, std::memory_order_relaxed);
+}
+
+void FRuntimeEditableLandscapeModule::ResetStageTimings()
+{
+	for (int32 Stage = 0; Stage < static_cast<int32>(ERuntimeLandscapeStage::Num); ++Stage)
+	{
+		StageCycles[Stage].store(0, std::memory_order_relaxed);
+		StageCalls[Stage].store(0, std::memory_order_relaxed);
+	}
+}
+
+void FRuntimeEditableLandscapeModule::AddStageTime(ERuntimeLandscapeStage Stage, uint64 Cycles)
+{
+	StageCycles[static_cast<int32>(Stage)].fetch_add(Cycles, std::memory_order_relaxed);
+	StageCalls[static_cast<int32>(Stage)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void FRuntimeEditableLandscapeModule::GetStageTiming(ERuntimeLandscapeStage Stage, double& OutSeconds,
+                                                     int64& OutCalls)
+{
+	OutSeconds = FPlatformTime::ToSeconds64(StageCycles[static_cast<int32>(Stage)].load(std::memory_order_relaxed));
+	OutCalls = StageCalls[static_cast<int32>(Stage)].load(std::memory_order_relaxed);
+}
+
+const TCHAR* FRuntimeEditableLandscapeModule::GetStageName(ERuntimeLandscapeStage Stage)
+{
+	static const TCHAR* StageNames[] = {
+		TEXT("ApplyLayers"), TEXT("BuildVertices"), TEXT("Tangents"), TEXT("GenerateGrass"), TEXT("BuildGrassTrees"),
+		TEXT("UpdateGrass"), TEXT("GenerateTriangles"), TEXT("CommitMesh"), TEXT("MeshCache"), TEXT("MeshCacheStore"),
+		TEXT("Foliage"), TEXT("Navigation"), TEXT("NavigationExport")
+	};
+	static_assert(UE_ARRAY_COUNT(StageNames) == static_cast<int32>(ERuntimeLandscapeStage::Num));
+
+	return StageNames[static_cast<int32>(Stage)];
+}
+
+void FRuntimeEditableLandscapeModule::RecordCsvStats()
+{
+#if CSV_PROFILER
+	constexpr double BytesToMB = 1.0 / (1024.0 * 1024.0);
+	auto LoadMB = [](ERuntimeLandscapeMemory Type)
+	{
+		return static_cast<float>(TrackedMemory[static_cast<int32>(Type)].load(std::memory_order_relaxed) * BytesToMB);
+	};
+
+	CSV_CUSTOM_STAT(RuntimeLandscape, QueuedRebuilds, QueuedRebuilds.load(std::memory_order_relaxed),
+	                ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(RuntimeLandscape, RebuildsInFlight, RebuildsInFlight.load(std::memory_order_relaxed),
+	                ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(RuntimeLandscape, HeightsMB, LoadMB(ERuntimeLandscapeMemory::Heights), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(RuntimeLandscape, GroundTypeWeightsMB, LoadMB(ERuntimeLandscapeMemory::GroundTypeWeights),
+	                ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(RuntimeLandscape, GrassMB, LoadMB(ERuntimeLandscapeMemory::Grass), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(RuntimeLandscape, RebuildBuffersMB, LoadMB(ERuntimeLandscapeMemory::RebuildBuffers),
+	                ECsvCustomStatOp::Set);
+#endif
 }
 
 #undef LOCTEXT_NAMESPACE
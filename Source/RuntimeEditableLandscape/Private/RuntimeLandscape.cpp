@@ -3,17 +3,22 @@
 
 #include "RuntimeLandscape.h"
 
+#include "GroundTypeBrushRasterizer.h"
 #include "ImageUtils.h"
 #include "Landscape.h"
 #include "LandscapeLayerComponent.h"
+#include "NavigationSystem.h"
+#include "RenderingThread.h"
 #include "RuntimeEditableLandscape.h"
 #include "RuntimeLandscapeComponent.h"
+#include "RuntimeLandscapeDeltaSave.h"
+#include "RuntimeLandscapeSubsystem.h"
+#include "TextureResource.h"
+#include "Async/ParallelFor.h"
 #include "Chaos/HeightField.h"
 #include "Components/HierarchicalInstancedStaticMeshComponent.h"
-#include "Engine/Canvas.h"
-#include "Kismet/KismetMaterialLibrary.h"
-#include "Kismet/KismetRenderingLibrary.h"
-#include "LayerTypes/LandscapeGroundTypeLayerData.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "GameFramework/PlayerController.h"
 #include "LayerTypes/LandscapeLayerDataBase.h"
 #include "Threads/RuntimeLandscapeRebuildManager.h"
 
@@ -31,13 +36,6 @@ TArray<FName> FRuntimeLandscapeGroundTypeLayerSet::GetLayerNames() const
 	return Result;
 }
 
-int32 FRuntimeLandscapeGroundTypeLayerSet::GetPixelIndexForCoordinates(FIntVector2 VertexCoords) const
-{
-	int32 Result = VertexCoords.X;
-	Result += VertexCoords.Y * RenderTarget->SizeX;
-	return Result;
-}
-
 ARuntimeLandscape::ARuntimeLandscape() : Super()
 {
 	RootComponent = CreateDefaultSubobject<USceneComponent>("Root component");
@@ -58,6 +56,8 @@ void ARuntimeLandscape::AddLandscapeLayer(const ULandscapeLayerComponent* LayerT
 	SCOPE_CYCLE_COUNTER(STAT_AddLandscapeLayer);
 	if (ensure(LayerToAdd))
 	{
+		FRuntimeLandscapeEditScope EditScope(*this, ERuntimeLandscapeEditType::AddLayer);
+
 		// apply layer effects to whole landscape
 		for (const ULandscapeLayerDataBase* Layer : LayerToAdd->GetLayerData())
 		{
@@ -73,53 +73,102 @@ void ARuntimeLandscape::AddLandscapeLayer(const ULandscapeLayerComponent* LayerT
 }
 
 void ARuntimeLandscape::DrawGroundType(const ULandscapeGroundTypeData* GroundType, ELayerShape Shape,
-                                       const FTransform& WorldTransform, const FVector& BrushExtent)
+                                       const FTransform& WorldTransform, const FVector& BrushExtent, float Falloff)
 {
-	FRuntimeLandscapeGroundTypeLayerSet* LayerSet = nullptr;
-	for (FRuntimeLandscapeGroundTypeLayerSet& CurrentLayerSet : GroundLayerSets)
+	const FGroundTypeLayerIndex* TargetLayer = TryGetGroundTypeLayerIndex(GroundType);
+	if (!ensure(TargetLayer))
 	{
-		if (CurrentLayerSet.GroundTypes.Contains(GroundType))
-		{
-			LayerSet = &CurrentLayerSet;
-			break;
-		}
+		return;
 	}
 
-	FGroundTypeBrushData BrushData = GroundTypeBrushes.FindRef(Shape);
-	UMaterialInstanceDynamic* MaskBrushMaterial = BrushData.BrushMaterialInstance;
+	const FGroundTypeBrushRasterizer Rasterizer(Shape, WorldTransform, FVector2D(BrushExtent), Falloff);
+	const FVector2D GridOrigin = FVector2D(GetOriginLocation());
+	const FIntRect Area = Rasterizer.GetAffectedVertexRect(GridOrigin, QuadSideLength, GetWeightMapSize());
+	if (Area.Width() <= 0 || Area.Height() <= 0)
+	{
+		return;
+	}
 
-	if (ensure(MaskBrushMaterial && LayerSet))
+	FRuntimeLandscapeEditScope EditScope(*this, ERuntimeLandscapeEditType::DrawGroundType);
+
+	const FIntPoint ComponentVertexAmount(VertexAmountPerComponent.X, VertexAmountPerComponent.Y);
+	const int32 VertexAmount = GetTotalVertexAmountPerComponent();
+
+	for (URuntimeLandscapeComponent* Component : GetComponentsInArea(GetVertexAreaBounds(Area)))
 	{
-		UCanvas* Canvas;
-		FDrawToRenderTargetContext RenderTargetContext;
-		FVector2D RenderTargetSize;
-		UKismetRenderingLibrary::BeginDrawCanvasToRenderTarget(GetWorld(), LayerSet->RenderTarget, Canvas,
-		                                                       RenderTargetSize,
-		                                                       RenderTargetContext);
+		FIntVector2 ComponentCoordinates;
+		GetComponentCoordinates(Component->GetComponentIndex(), ComponentCoordinates);
+		const FIntPoint ComponentOffset(ComponentCoordinates.X * FMath::RoundToInt(ComponentResolution.X),
+		                                ComponentCoordinates.Y * FMath::RoundToInt(ComponentResolution.Y));
+		const FIntRect LocalArea(FIntPoint::ComponentMax(Area.Min - ComponentOffset, FIntPoint::ZeroValue),
+		                         FIntPoint::ComponentMin(Area.Max - ComponentOffset, ComponentVertexAmount));
+		if (LocalArea.Width() <= 0 || LocalArea.Height() <= 0)
+		{
+			continue;
+		}
 
-		// calculate Position
-		const FVector RelativePosition = WorldTransform.GetLocation() - GetOriginLocation() - BrushExtent;
-		const FVector2D Position = FVector2D(RelativePosition.X / LandscapeSize.X,
-		                                     RelativePosition.Y / LandscapeSize.Y);
-		const FVector2D ScreenPosition = FVector2D(Position.X * Canvas->SizeX, Position.Y * Canvas->SizeY);
+		FGroundTypeWeightTile& Tile = Component->GroundTypeWeights;
+		Tile.GetOrAllocatePlane(TargetLayer->Plane, VertexAmount);
 
-		// calculate brush size
-		const float AspectRatio = Canvas->SizeY / Canvas->SizeX;
-		const float ScaleFactor = RenderTargetSize.X / LandscapeSize.X;
-		const FVector BoxSize = BrushExtent * 2.0f;
-		const FVector2D BrushSize = FVector2D(BoxSize.X, BoxSize.Y * AspectRatio) * ScaleFactor;
+		for (int32 Y = LocalArea.Min.Y; Y < LocalArea.Max.Y; ++Y)
+		{
+			for (int32 X = LocalArea.Min.X; X < LocalArea.Max.X; ++X)
+			{
+				const float Strength = Rasterizer.GetStrength(
+					GridOrigin + FVector2D(ComponentOffset + FIntPoint(X, Y)) * QuadSideLength);
+				if (Strength <= 0.0f)
+				{
+					continue;
+				}
+
+				// the painted ground type fades in, all other ground types fade out
+				const int32 VertexIndex = X + Y * ComponentVertexAmount.X;
+				for (int32 Plane = 0; Plane < Tile.Planes.Num(); ++Plane)
+				{
+					TArray<uint8>& Weights = Tile.Planes[Plane].Weights;
+					if (Weights.IsEmpty())
+					{
+						continue;
+					}
 
-		const float Yaw = WorldTransform.GetRotation().Rotator().Yaw;
-		FLinearColor ColorChannel = LayerSet->GetColorChannelForLayer(GroundType);
-		MaskBrushMaterial->SetVectorParameterValue(MATERIAL_PARAMETER_GROUND_TYPE_LAYER_COLOR, ColorChannel);
+					const float Target = Plane == TargetLayer->Plane ? 255.0f : 0.0f;
+					Weights[VertexIndex] = FMath::RoundToInt(
+						FMath::Lerp(static_cast<float>(Weights[VertexIndex]), Target, Strength));
+				}
+			}
+		}
 
-		Canvas->K2_DrawMaterial(MaskBrushMaterial, ScreenPosition, BrushSize, FVector2D::Zero(),
-		                        FVector2D::UnitVector, Yaw);
+		Tile.ReleaseEmptyPlanes();
+		Tile.UpdateDominantPlanes(VertexAmount);
+		Component->MarkGroundTypeWeightsChanged();
+		FRuntimeLandscapeDeltaSave::MarkWeightsEdited(*Component, LocalArea);
+	}
 
-		UpdateVertexLayerWeights(*LayerSet);
+	for (int32 LayerSetIndex = 0; LayerSetIndex < GroundLayerSets.Num(); ++LayerSetIndex)
+	{
+		UpdateRenderTargetFromWeights(LayerSetIndex, Area);
 	}
 }
 
+void ARuntimeLandscape::SaveEdits(TArray<uint8>& OutData) const
+{
+	FRuntimeLandscapeDeltaSave::Write(*this, OutData);
+}
+
+bool ARuntimeLandscape::LoadEdits(const TArray<uint8>& Data)
+{
+	return FRuntimeLandscapeDeltaSave::Apply(*this, Data);
+}
+
+int32 ARuntimeLandscape::GetEditLatencyPercentiles(float& OutP50, float& OutP95, float& OutP99) const
+{
+	const FRuntimeLandscapeLatencyHistogram& Latency = EditTracker.GetLatency();
+	OutP50 = static_cast<float>(Latency.GetPercentile(50.0));
+	OutP95 = static_cast<float>(Latency.GetPercentile(95.0));
+	OutP99 = static_cast<float>(Latency.GetPercentile(99.0));
+	return static_cast<int32>(Latency.GetSampleAmount());
+}
+
 // ReSharper disable once CppParameterMayBeConstPtrOrRef - bound to delegate
 void ARuntimeLandscape::HandleLandscapeLayerOwnerDestroyed(AActor* DestroyedActor)
 {
@@ -132,9 +181,23 @@ void ARuntimeLandscape::HandleLandscapeLayerOwnerDestroyed(AActor* DestroyedActo
 	}
 }
 
+void ARuntimeLandscape::HandleTransformUpdated(USceneComponent* SceneComponent,
+                                               EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	if (URuntimeLandscapeSubsystem* Subsystem = GetWorld()->GetSubsystem<URuntimeLandscapeSubsystem>())
+	{
+		Subsystem->RegisterLandscape(this);
+	}
+}
+
 void ARuntimeLandscape::PostLoad()
 {
 	Super::PostLoad();
+	UpdateGroundTypeLayerIndices();
+#if WITH_EDITORONLY_DATA
+	ConvertDeprecatedHeights();
+	ConvertDeprecatedGroundTypeBrushes();
+#endif
 
 	// Bake layers after editor load
 	if (ParentLandscape)
@@ -144,81 +207,192 @@ void ARuntimeLandscape::PostLoad()
 	}
 }
 
+void ARuntimeLandscape::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	if (URuntimeLandscapeSubsystem* Subsystem = GetWorld()->GetSubsystem<URuntimeLandscapeSubsystem>())
+	{
+		Subsystem->RegisterLandscape(this);
+	}
+
+	if (RootComponent)
+	{
+		RootComponent->TransformUpdated.AddUObject(this, &ARuntimeLandscape::HandleTransformUpdated);
+	}
+}
+
 void ARuntimeLandscape::BeginPlay()
 {
 	Super::BeginPlay();
+	UpdateGroundTypeLayerIndices();
 
-	UWorld* World = GetWorld();
+	if (bBakeLayersOnBeginPlay)
+	{
+		BakeLandscapeLayers();
+	}
 
-	// initialize brushes
-	for (auto& GroundTypeBrush : GroundTypeBrushes)
+	if (bStreamComponents)
 	{
-		GroundTypeBrush.Value.BrushMaterialInstance = UKismetMaterialLibrary::CreateDynamicMaterialInstance(
-			World, GroundTypeBrush.Value.BrushMaterial);
+		UpdateComponentStreaming();
+		GetWorldTimerManager().SetTimer(ComponentStreamingTimer, this, &ARuntimeLandscape::UpdateComponentStreaming,
+		                                ComponentStreamingInterval, true);
 	}
 
-	if (bBakeLayersOnBeginPlay)
+	if (bStreamGrass)
+	{
+		for (URuntimeLandscapeComponent* Component : LandscapeComponents)
+		{
+			Component->SetGrassEnabled(false);
+		}
+
+		UpdateGrassStreaming();
+		GetWorldTimerManager().SetTimer(GrassStreamingTimer, this, &ARuntimeLandscape::UpdateGrassStreaming,
+		                                GrassStreamingInterval, true);
+	}
+}
+
+void ARuntimeLandscape::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+#if WITH_EDITORONLY_DATA
+	if (EndPlayReason == EEndPlayReason::Type::EndPlayInEditor)
 	{
 		BakeLandscapeLayers();
 	}
+#endif
+
+	float P50, P95, P99;
+	const int32 EditAmount = GetEditLatencyPercentiles(P50, P95, P99);
+	if (EditAmount > 0)
+	{
+		UE_LOG(RuntimeEditableLandscape, Display,
+		       TEXT("Edit latency of %s: p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.1f ms (%i edits)"),
+		       *GetName(), P50, P95, P99, EditTracker.GetLatency().GetMaxLatency(), EditAmount);
+	}
+
+	if (RootComponent)
+	{
+		RootComponent->TransformUpdated.RemoveAll(this);
+	}
+
+	if (URuntimeLandscapeSubsystem* Subsystem = GetWorld()->GetSubsystem<URuntimeLandscapeSubsystem>())
+	{
+		Subsystem->UnregisterLandscape(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void ARuntimeLandscape::RemoveLandscapeLayer(const ULandscapeLayerComponent* Layer)
 {
+	FRuntimeLandscapeEditScope EditScope(*this, ERuntimeLandscapeEditType::RemoveLayer);
 	for (URuntimeLandscapeComponent* LandscapeComponent : LandscapeComponents)
 	{
 		LandscapeComponent->RemoveLandscapeLayer(Layer);
 	}
 }
 
-TMap<const ULandscapeGroundTypeData*, float> ARuntimeLandscape::GetGroundTypeLayerWeightsAtVertexCoordinates(
-	int32 SectionIndex, int32 X, int32 Y) const
+bool ARuntimeLandscape::CommitLandscapeLayer(const ULandscapeLayerComponent* Layer)
+{
+	// the committed layer ends up below all remaining layers, so it has to be below them already
+	for (const URuntimeLandscapeComponent* LandscapeComponent : LandscapeComponents)
+	{
+		if (LandscapeComponent && LandscapeComponent->GetAffectingLayers().Contains(Layer)
+			&& !LandscapeComponent->CanCommitLandscapeLayer(Layer))
+		{
+			UE_LOG(RuntimeEditableLandscape, Warning,
+			       TEXT("Layer %s can't be committed, because it overlaps a layer that is applied before it!"),
+			       *GetNameSafe(Layer->GetOwner()));
+			return false;
+		}
+	}
+
+	for (URuntimeLandscapeComponent* LandscapeComponent : LandscapeComponents)
+	{
+		if (LandscapeComponent && LandscapeComponent->GetAffectingLayers().Contains(Layer))
+		{
+			LandscapeComponent->CommitLandscapeLayer(Layer);
+			LandscapeComponent->RemoveLandscapeLayer(Layer);
+		}
+	}
+
+	return true;
+}
+
+FRuntimeLandscapeSnapshot ARuntimeLandscape::CreateSnapshot() const
 {
-	FIntVector2 VertexCoordinates;
-	GetVertexCoordinatesWithinLandscape(SectionIndex, X, Y, VertexCoordinates);
+	FRuntimeLandscapeSnapshot Snapshot;
+	Snapshot.ComponentHeights.Reserve(LandscapeComponents.Num());
+	for (const URuntimeLandscapeComponent* LandscapeComponent : LandscapeComponents)
+	{
+		Snapshot.ComponentHeights.Add(LandscapeComponent
+			                              ? LandscapeComponent->EditedHeights
+			                              : FRuntimeLandscapeHeightTiles());
+	}
 
-	TMap<const ULandscapeGroundTypeData*, float> Result;
+	return Snapshot;
+}
 
-	for (const FRuntimeLandscapeGroundTypeLayerSet& LayerSet : GroundLayerSets)
+void ARuntimeLandscape::RestoreSnapshot(const FRuntimeLandscapeSnapshot& Snapshot)
+{
+	if (!ensureMsgf(Snapshot.ComponentHeights.Num() == LandscapeComponents.Num(),
+	                TEXT("The snapshot was taken from a different landscape layout!")))
 	{
-		if (ensure(LayerSet.RenderTarget))
+		return;
+	}
+
+	for (int32 ComponentIndex = 0; ComponentIndex < LandscapeComponents.Num(); ++ComponentIndex)
+	{
+		URuntimeLandscapeComponent* LandscapeComponent = LandscapeComponents[ComponentIndex];
+		const FRuntimeLandscapeHeightTiles& SnapshotHeights = Snapshot.ComponentHeights[ComponentIndex];
+		if (LandscapeComponent && !LandscapeComponent->EditedHeights.HasSameTiles(SnapshotHeights))
 		{
-			int32 PixelIndex = LayerSet.GetPixelIndexForCoordinates(VertexCoordinates);
-			if (ensure(LayerSet.VertexLayerWeights.IsValidIndex(PixelIndex)))
-			{
-				const FColor& ColorAtPixel = LayerSet.VertexLayerWeights[PixelIndex];
-				int32 LayerIndex = 0;
-				for (const ULandscapeGroundTypeData* Layer : LayerSet.GroundTypes)
-				{
-					uint8 Value = 0;
-					switch (LayerIndex)
-					{
-					case 0:
-						Value = ColorAtPixel.R;
-						break;
-					case 1:
-						Value = ColorAtPixel.G;
-						break;
-					case 2:
-						Value = ColorAtPixel.B;
-						break;
-					case 3:
-						Value = ColorAtPixel.A;
-						break;
-					default:
-						checkNoEntry();
-					}
-					float LayerWeight = Value / 255.0f;
-					Result.Add(Layer, LayerWeight);
-					++LayerIndex;
-				}
-			}
+			LandscapeComponent->EditedHeights = SnapshotHeights;
+			LandscapeComponent->Rebuild();
 		}
 	}
+}
+
+TMap<const ULandscapeGroundTypeData*, float> ARuntimeLandscape::GetGroundTypeLayerWeightsAtVertexCoordinates(
+	int32 SectionIndex, int32 X, int32 Y) const
+{
+	TMap<const ULandscapeGroundTypeData*, float> Result;
+
+	const URuntimeLandscapeComponent* Component = LandscapeComponents[SectionIndex];
+	const int32 VertexIndex = X + Y * VertexAmountPerComponent.X;
+	for (int32 Plane = 0; Plane < GroundTypesByPlane.Num(); ++Plane)
+	{
+		const float LayerWeight = Component->GetGroundTypeWeights().GetWeight(Plane, VertexIndex) / 255.0f;
+		Result.Add(GroundTypesByPlane[Plane], LayerWeight);
+	}
 
 	return Result;
 }
 
+void ARuntimeLandscape::GetDominantGroundTypes(int32 SectionIndex, TArray<uint8>& OutPlanes,
+                                               TArray<uint8>& OutWeights) const
+{
+	const FGroundTypeWeightTile& Tile = LandscapeComponents[SectionIndex]->GetGroundTypeWeights();
+	const int32 VertexAmount = GetTotalVertexAmountPerComponent();
+	OutPlanes.SetNumUninitialized(VertexAmount);
+	OutWeights.SetNumUninitialized(VertexAmount);
+	for (int32 VertexIndex = 0; VertexIndex < VertexAmount; ++VertexIndex)
+	{
+		const uint8 Plane = Tile.GetDominantPlane(VertexIndex);
+		OutPlanes[VertexIndex] = Plane;
+		OutWeights[VertexIndex] = Plane == GROUND_TYPE_PLANE_NONE ? 0 : Tile.Planes[Plane].Weights[VertexIndex];
+	}
+}
+
+FBox2D ARuntimeLandscape::GetVertexAreaBounds(const FIntRect& VertexArea) const
+{
+	const FVector2D GridOrigin = FVector2D(GetOriginLocation());
+	// expand by half a quad, so components that share the border vertices are included
+	return FBox2D(GridOrigin + FVector2D(VertexArea.Min) * QuadSideLength,
+	              GridOrigin + FVector2D(VertexArea.Max - FIntPoint(1, 1)) * QuadSideLength).
+		ExpandBy(QuadSideLength * 0.5f);
+}
+
 TArray<URuntimeLandscapeComponent*> ARuntimeLandscape::GetComponentsInArea(const FBox2D& Area) const
 {
 	const FVector2D StartLocation = FVector2D(LandscapeComponents[0]->GetComponentLocation());
@@ -297,6 +471,12 @@ FVector ARuntimeLandscape::GetOriginLocation() const
 	return GetActorLocation();
 }
 
+FBox2D ARuntimeLandscape::GetWorldBounds() const
+{
+	const FVector2D Origin = FVector2D(GetOriginLocation());
+	return FBox2D(Origin, Origin + LandscapeSize);
+}
+
 FBox2D ARuntimeLandscape::GetComponentBounds(int32 SectionIndex) const
 {
 	const FVector2D SectionSize = LandscapeSize / ComponentAmount;
@@ -308,22 +488,505 @@ FBox2D ARuntimeLandscape::GetComponentBounds(int32 SectionIndex) const
 		FVector2D((SectionCoordinates.X + 1) * SectionSize.X, (SectionCoordinates.Y + 1) * SectionSize.Y));
 }
 
-void ARuntimeLandscape::UpdateVertexLayerWeights(FRuntimeLandscapeGroundTypeLayerSet& LayerSet)
+void ARuntimeLandscape::SetAdditionalGroundTypes(const TArray<TObjectPtr<const ULandscapeGroundTypeData>>& GroundTypes)
+{
+	AdditionalGroundTypes = GroundTypes;
+	UpdateGroundTypeLayerIndices();
+}
+
+void ARuntimeLandscape::UpdateGroundTypeLayerIndices()
+{
+	GroundTypeLayerIndices.Empty();
+	GroundTypesByPlane.Empty();
+
+	auto AddGroundType = [this](const ULandscapeGroundTypeData* GroundType, int32 LayerSet, int32 Channel)
+	{
+		if (GroundType && !GroundTypeLayerIndices.Contains(GroundType))
+		{
+			FGroundTypeLayerIndex& LayerIndex = GroundTypeLayerIndices.Add(GroundType);
+			LayerIndex.Plane = GroundTypesByPlane.Add(GroundType);
+			LayerIndex.LayerSet = LayerSet;
+			LayerIndex.Channel = Channel;
+		}
+	};
+
+	for (int32 LayerSetIndex = 0; LayerSetIndex < GroundLayerSets.Num(); ++LayerSetIndex)
+	{
+		const TArray<const ULandscapeGroundTypeData*>& GroundTypes = GroundLayerSets[LayerSetIndex].GroundTypes;
+		for (int32 Channel = 0; Channel < GroundTypes.Num(); ++Channel)
+		{
+			AddGroundType(GroundTypes[Channel], LayerSetIndex, Channel);
+		}
+	}
+
+	for (const ULandscapeGroundTypeData* GroundType : AdditionalGroundTypes)
+	{
+		AddGroundType(GroundType, INDEX_NONE, INDEX_NONE);
+	}
+
+	ensureMsgf(GroundTypesByPlane.Num() <= MAX_GROUND_TYPE_PLANES, TEXT("%s uses more than %i ground types!"),
+	           *GetName(), MAX_GROUND_TYPE_PLANES);
+	UpdateGrassRules();
+}
+
+void ARuntimeLandscape::UpdateGrassRules()
+{
+	// running rebuilds keep the table they started with
+	const TSharedRef<FGrassRuleTable> NewGrassRules = MakeShared<FGrassRuleTable>();
+	NewGrassRules->Build(GroundTypesByPlane, HeightBasedData);
+	GrassRules = NewGrassRules;
+
+	// existing grass might have been selected by different rules
+	for (URuntimeLandscapeComponent* Component : LandscapeComponents)
+	{
+		if (Component)
+		{
+			Component->MarkGroundTypeWeightsChanged();
+		}
+	}
+}
+
+void ARuntimeLandscape::UpdateVertexLayerWeights(int32 LayerSetIndex)
 {
+	const FRuntimeLandscapeGroundTypeLayerSet& LayerSet = GroundLayerSets[LayerSetIndex];
 	FImage MaskImage;
 	FImageUtils::GetRenderTargetImage(LayerSet.RenderTarget, MaskImage);
-	TArrayView64<FColor> MaskValues = MaskImage.AsBGRA8();
-	LayerSet.VertexLayerWeights = MaskValues;
+	const TArrayView64<FColor> MaskValues = MaskImage.AsBGRA8();
+	if (!ensure(FIntPoint(MaskImage.SizeX, MaskImage.SizeY) == GetWeightMapSize()))
+	{
+		return;
+	}
+
+	const int32 VertexAmount = GetTotalVertexAmountPerComponent();
+	for (URuntimeLandscapeComponent* Component : LandscapeComponents)
+	{
+		if (!Component)
+		{
+			continue;
+		}
+
+		FIntVector2 ComponentCoordinates;
+		GetComponentCoordinates(Component->GetComponentIndex(), ComponentCoordinates);
+		const int32 OffsetX = ComponentCoordinates.X * FMath::RoundToInt(ComponentResolution.X);
+		const int32 OffsetY = ComponentCoordinates.Y * FMath::RoundToInt(ComponentResolution.Y);
+
+		for (int32 Channel = 0; Channel < LayerSet.GroundTypes.Num(); ++Channel)
+		{
+			// ground types that are used by multiple layer sets are only read from the first one
+			const FGroundTypeLayerIndex* LayerIndex = TryGetGroundTypeLayerIndex(LayerSet.GroundTypes[Channel]);
+			if (!LayerIndex || LayerIndex->LayerSet != LayerSetIndex)
+			{
+				continue;
+			}
+
+			TArray<uint8>& Weights = Component->GroundTypeWeights.GetOrAllocatePlane(LayerIndex->Plane, VertexAmount);
+			for (int32 Y = 0; Y < VertexAmountPerComponent.Y; ++Y)
+			{
+				for (int32 X = 0; X < VertexAmountPerComponent.X; ++X)
+				{
+					const int32 PixelIndex = OffsetX + X + (OffsetY + Y) * MaskImage.SizeX;
+					Weights[X + Y * VertexAmountPerComponent.X] = FRuntimeLandscapeGroundTypeLayerSet::GetChannelValue(
+						MaskValues[PixelIndex], Channel);
+				}
+			}
+		}
+
+		Component->GroundTypeWeights.ReleaseEmptyPlanes();
+		Component->GroundTypeWeights.UpdateDominantPlanes(VertexAmount);
+		Component->MarkGroundTypeWeightsChanged();
+		// the baked weights are the new base of saved edits
+		Component->EditedWeightTiles.Empty();
+	}
+}
+
+void ARuntimeLandscape::UpdateRenderTargetFromWeights(int32 LayerSetIndex, const FIntRect& Area) const
+{
+	const FRuntimeLandscapeGroundTypeLayerSet& LayerSet = GroundLayerSets[LayerSetIndex];
+	if (!LayerSet.RenderTarget || !FApp::CanEverRender() || LandscapeComponents.IsEmpty())
+	{
+		return;
+	}
+
+	const FIntPoint WeightMapSize = GetWeightMapSize();
+	FTextureRenderTargetResource* Resource = LayerSet.RenderTarget->GameThread_GetRenderTargetResource();
+	if (!Resource || LayerSet.RenderTarget->SizeX != WeightMapSize.X || LayerSet.RenderTarget->SizeY != WeightMapSize.Y)
+	{
+		return;
+	}
+
+	if (!ensureMsgf(LayerSet.RenderTarget->GetFormat() == PF_B8G8R8A8,
+	                TEXT("Ground type render target %s has to use RTF_RGBA8 to be updated from CPU weights!"),
+	                *LayerSet.RenderTarget->GetName()))
+	{
+		return;
+	}
+
+	// find the weight planes of the channels
+	int32 ChannelPlanes[4] = {INDEX_NONE, INDEX_NONE, INDEX_NONE, INDEX_NONE};
+	for (int32 Channel = 0; Channel < FMath::Min(LayerSet.GroundTypes.Num(), 4); ++Channel)
+	{
+		const FGroundTypeLayerIndex* LayerIndex = TryGetGroundTypeLayerIndex(LayerSet.GroundTypes[Channel]);
+		if (LayerIndex && LayerIndex->LayerSet == LayerSetIndex)
+		{
+			ChannelPlanes[Channel] = LayerIndex->Plane;
+		}
+	}
+
+	// compose the area from the component tiles
+	const int32 ComponentResolutionX = FMath::RoundToInt(ComponentResolution.X);
+	const int32 ComponentResolutionY = FMath::RoundToInt(ComponentResolution.Y);
+	const int32 ComponentAmountX = FMath::RoundToInt(ComponentAmount.X);
+	const int32 ComponentAmountY = FMath::RoundToInt(ComponentAmount.Y);
+	TArray<FColor> AreaWeights;
+	AreaWeights.Reserve(Area.Area());
+	for (int32 Y = Area.Min.Y; Y < Area.Max.Y; ++Y)
+	{
+		const int32 ComponentY = FMath::Min(Y / ComponentResolutionY, ComponentAmountY - 1);
+		const int32 LocalY = Y - ComponentY * ComponentResolutionY;
+		for (int32 X = Area.Min.X; X < Area.Max.X; ++X)
+		{
+			const int32 ComponentX = FMath::Min(X / ComponentResolutionX, ComponentAmountX - 1);
+			const int32 LocalVertexIndex = X - ComponentX * ComponentResolutionX + LocalY * VertexAmountPerComponent.X;
+			const URuntimeLandscapeComponent* Component = LandscapeComponents[ComponentX + ComponentY *
+				ComponentAmountX];
+
+			FColor& Color = AreaWeights.Add_GetRef(FColor(0, 0, 0, 0));
+			for (int32 Channel = 0; Channel < 4; ++Channel)
+			{
+				if (Component && ChannelPlanes[Channel] != INDEX_NONE)
+				{
+					FRuntimeLandscapeGroundTypeLayerSet::GetChannelValue(Color, Channel) = Component->
+						GetGroundTypeWeights().GetWeight(ChannelPlanes[Channel], LocalVertexIndex);
+				}
+			}
+		}
+	}
+
+	ENQUEUE_RENDER_COMMAND(UpdateGroundTypeRenderTarget)(
+		[Resource, Area, AreaWeights = MoveTemp(AreaWeights)](FRHICommandListImmediate& RHICmdList)
+		{
+			const FUpdateTextureRegion2D Region(Area.Min.X, Area.Min.Y, 0, 0, Area.Width(), Area.Height());
+			RHICmdList.UpdateTexture2D(Resource->GetRenderTargetTexture(), 0, Region, Area.Width() * sizeof(FColor),
+			                           reinterpret_cast<const uint8*>(AreaWeights.GetData()));
+		});
+}
+
+void ARuntimeLandscape::WarnHeightClamped(float Height) const
+{
+	if (!bHasWarnedHeightClamped.exchange(true))
+	{
+		UE_LOG(RuntimeEditableLandscape, Warning,
+		       TEXT("%s: height %f is outside of the storable range [%f, %f] and is clamped!"), *GetName(), Height,
+		       DequantizeHeight(0), DequantizeHeight(MAX_uint16));
+	}
+}
+
+int32 ARuntimeLandscape::UpdateGrassClusters(const URuntimeLandscapeComponent& ChangedComponent)
+{
+	FIntVector2 ComponentCoordinates;
+	GetComponentCoordinates(ChangedComponent.GetComponentIndex(), ComponentCoordinates);
+	const FIntPoint ComponentResolutionInt(FMath::RoundToInt(ComponentResolution.X),
+	                                       FMath::RoundToInt(ComponentResolution.Y));
+	const FIntPoint FirstVertex(ComponentCoordinates.X * ComponentResolutionInt.X,
+	                            ComponentCoordinates.Y * ComponentResolutionInt.Y);
+	const FIntPoint LastVertex = FirstVertex + ComponentResolutionInt;
+
+	const int32 ClusterVertexAmount = GetGrassClusterVertexAmount();
+	const FIntPoint FirstCluster = FirstVertex / ClusterVertexAmount;
+	const FIntPoint LastCluster = LastVertex / ClusterVertexAmount;
+
+	int32 ChangedInstanceAmount = 0;
+	for (int32 Y = FirstCluster.Y; Y <= LastCluster.Y; ++Y)
+	{
+		for (int32 X = FirstCluster.X; X <= LastCluster.X; ++X)
+		{
+			ChangedInstanceAmount += UpdateGrassCluster(FIntPoint(X, Y), ChangedComponent);
+		}
+	}
+
+	return ChangedInstanceAmount;
+}
+
+int32 ARuntimeLandscape::UpdateGrassCluster(const FIntPoint& Cluster,
+                                            const URuntimeLandscapeComponent& ChangedComponent)
+{
+	const FIntPoint ClusterAmount = GetGrassClusterAmount();
+	if (GrassClusters.Num() != ClusterAmount.X * ClusterAmount.Y)
+	{
+		GrassClusters.SetNum(ClusterAmount.X * ClusterAmount.Y);
+	}
+
+	const int32 ClusterVertexAmount = GetGrassClusterVertexAmount();
+	const FIntPoint ClusterFirstVertex = Cluster * ClusterVertexAmount;
+	const FVector ClusterLocation = GetOriginLocation() + FVector(FVector2D(ClusterFirstVertex) * QuadSideLength, 0.0f);
+
+	// the component owns all of its vertices except the first row and column, which belong to its neighbors
+	FIntVector2 ComponentCoordinates;
+	GetComponentCoordinates(ChangedComponent.GetComponentIndex(), ComponentCoordinates);
+	const FIntPoint ComponentResolutionInt(FMath::RoundToInt(ComponentResolution.X),
+	                                       FMath::RoundToInt(ComponentResolution.Y));
+	const FIntPoint ComponentOffset = FIntPoint(ComponentCoordinates.X * ComponentResolutionInt.X,
+	                                            ComponentCoordinates.Y * ComponentResolutionInt.Y) - ClusterFirstVertex;
+	FIntRect OwnedArea(ComponentOffset + FIntPoint(1), ComponentOffset + ComponentResolutionInt + FIntPoint(1));
+	OwnedArea.Clip(FIntRect(FIntPoint::ZeroValue, FIntPoint(ClusterVertexAmount)));
+	if (OwnedArea.IsEmpty())
+	{
+		return 0;
+	}
+
+	// collect the grass of the component inside the cluster, relative to the cluster
+	// the component grass is sorted by vertex, so the cluster grass is sorted as well
+	FLandscapeGrassData ClusterGrass;
+	const FVector LocationOffset = ChangedComponent.GetComponentLocation() - ClusterLocation;
+	for (const FLandscapeGrassMeshBuffer& MeshBuffer : ChangedComponent.GeneratedGrass.MeshBuffers)
+	{
+		FLandscapeGrassMeshBuffer* ClusterBuffer = nullptr;
+		for (int32 i = 0; i < MeshBuffer.InstanceVertices.Num(); ++i)
+		{
+			const FIntPoint ClusterVertex = ComponentOffset + FIntPoint(
+				MeshBuffer.InstanceVertices[i] % VertexAmountPerComponent.X,
+				MeshBuffer.InstanceVertices[i] / VertexAmountPerComponent.X);
+			if (!OwnedArea.Contains(ClusterVertex))
+			{
+				continue;
+			}
+
+			if (!ClusterBuffer)
+			{
+				ClusterBuffer = &ClusterGrass.FindOrAddMeshBuffer(*MeshBuffer.GrassVariety);
+			}
+
+			FTransform InstanceTransform = MeshBuffer.InstanceTransformsRelative[i];
+			InstanceTransform.AddToTranslation(LocationOffset);
+			ClusterBuffer->InstanceTransformsRelative.Add(InstanceTransform);
+			ClusterBuffer->InstanceVertices.Add(ClusterVertex.X + ClusterVertex.Y * ClusterVertexAmount);
+		}
+	}
+
+	// patch the instances of the component in the cluster meshes
+	FRuntimeLandscapeGrassCluster& GrassCluster = GrassClusters[Cluster.X + Cluster.Y * ClusterAmount.X];
+	for (const FLandscapeGrassMeshBuffer& MeshBuffer : ClusterGrass.MeshBuffers)
+	{
+		FRuntimeLandscapeGrassMesh& GrassMesh = GrassCluster.GrassMeshes[FRuntimeLandscapeGrassMesh::FindOrAdd(
+			GrassCluster.GrassMeshes, *MeshBuffer.GrassVariety, RootComponent)];
+		GrassMesh.InstancedMesh->SetWorldLocation(ClusterLocation);
+		GrassMesh.ApplyVarietySettings(*MeshBuffer.GrassVariety);
+	}
+
+	int32 ChangedInstanceAmount = 0;
+	for (FRuntimeLandscapeGrassMesh& GrassMesh : GrassCluster.GrassMeshes)
+	{
+		if (!ensure(GrassMesh.InstancedMesh))
+		{
+			continue;
+		}
+
+		const FLandscapeGrassMeshBuffer* MeshBuffer = ClusterGrass.MeshBuffers.FindByPredicate(
+			[&GrassMesh](const FLandscapeGrassMeshBuffer& Current)
+			{
+				return Current.GrassVariety->GrassMesh == GrassMesh.InstancedMesh->GetStaticMesh();
+			});
+
+		if (MeshBuffer)
+		{
+			ChangedInstanceAmount += GrassMesh.UpdateInstancesInArea(MeshBuffer->InstanceTransformsRelative,
+			                                                         MeshBuffer->InstanceVertices,
+			                                                         ClusterVertexAmount, OwnedArea);
+		}
+		else
+		{
+			ChangedInstanceAmount += GrassMesh.UpdateInstancesInArea(TConstArrayView<FTransform>(),
+			                                                         TConstArrayView<int32>(), ClusterVertexAmount,
+			                                                         OwnedArea);
+		}
+	}
+
+	return ChangedInstanceAmount;
+}
+
+void ARuntimeLandscape::AddNavigationDirtyArea(const FBox& Area)
+{
+	if (!Area.IsValid)
+	{
+		return;
+	}
+
+	FBox MergedArea = Area;
+	for (int32 i = NavigationDirtyAreas.Num() - 1; i >= 0; --i)
+	{
+		if (NavigationDirtyAreas[i].Intersect(MergedArea))
+		{
+			MergedArea += NavigationDirtyAreas[i];
+			NavigationDirtyAreas.RemoveAtSwap(i);
+		}
+	}
+
+	NavigationDirtyAreas.Add(MergedArea);
+
+	// restart the delay on every change, so the areas are only submitted once the edits settle
+	if (NavigationUpdateDelay > 0.0f)
+	{
+		GetWorldTimerManager().SetTimer(NavigationUpdateTimer, this, &ARuntimeLandscape::FlushNavigationDirtyAreas,
+		                                NavigationUpdateDelay, false);
+	}
+	else if (!NavigationUpdateTimer.IsValid())
+	{
+		NavigationUpdateTimer = GetWorldTimerManager().SetTimerForNextTick(
+			this, &ARuntimeLandscape::FlushNavigationDirtyAreas);
+	}
+}
+
+void ARuntimeLandscape::FlushNavigationDirtyAreas()
+{
+	NavigationUpdateTimer.Invalidate();
+	if (NavigationDirtyAreas.IsEmpty())
+	{
+		return;
+	}
+
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		NavSys->AddDirtyAreas(NavigationDirtyAreas, ENavigationDirtyFlag::All);
+	}
+
+	NavigationDirtyAreas.Reset();
+}
+
+void ARuntimeLandscape::GetViewLocations(TArray<FVector>& OutViewLocations) const
+{
+	OutViewLocations.Reset();
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator->Get();
+		if (PlayerController && PlayerController->IsLocalController())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			OutViewLocations.Add(ViewLocation);
+		}
+	}
+}
+
+void ARuntimeLandscape::UpdateGrassStreaming()
+{
+	TArray<FVector> ViewLocations;
+	GetViewLocations(ViewLocations);
+
+	const double CurrentTime = GetWorld()->GetTimeSeconds();
+	const FVector2D Origin = FVector2D(GetOriginLocation());
+	const double RadiusSquared = FMath::Square(GrassStreamingRadius);
+
+	TArray<URuntimeLandscapeComponent*> ComponentsOutOfRange;
+	int32 InstanceAmountOutOfRange = 0;
+	for (URuntimeLandscapeComponent* Component : LandscapeComponents)
+	{
+		const FBox2D ComponentBounds = GetComponentBounds(Component->GetComponentIndex()).ShiftBy(Origin);
+		const bool bIsInRange = ViewLocations.ContainsByPredicate([&ComponentBounds, RadiusSquared](
+			const FVector& ViewLocation)
+			{
+				return ComponentBounds.ComputeSquaredDistanceToPoint(FVector2D(ViewLocation)) <= RadiusSquared;
+			});
+
+		if (bIsInRange)
+		{
+			Component->LastGrassViewTime = CurrentTime;
+			Component->SetGrassEnabled(true);
+		}
+		else if (Component->IsGrassEnabled())
+		{
+			ComponentsOutOfRange.Add(Component);
+			InstanceAmountOutOfRange += Component->GetGrassInstanceAmount();
+		}
+	}
+
+	// release the grass that was not viewed for the longest time first
+	ComponentsOutOfRange.Sort([](const URuntimeLandscapeComponent& A, const URuntimeLandscapeComponent& B)
+	{
+		return A.LastGrassViewTime < B.LastGrassViewTime;
+	});
+
+	for (URuntimeLandscapeComponent* Component : ComponentsOutOfRange)
+	{
+		if (InstanceAmountOutOfRange <= GrassInstanceBudget && GrassInstanceBudget > 0)
+		{
+			break;
+		}
+
+		InstanceAmountOutOfRange -= Component->GetGrassInstanceAmount();
+		Component->SetGrassEnabled(false);
+	}
+}
+
+void ARuntimeLandscape::UpdateComponentStreaming()
+{
+	TArray<FVector> ViewLocations;
+	GetViewLocations(ViewLocations);
+	if (ViewLocations.IsEmpty())
+	{
+		return;
+	}
+
+	const FVector2D Origin = FVector2D(GetOriginLocation());
+	const double StreamInRadiusSquared = FMath::Square(ComponentStreamingRadius);
+	const double StreamOutRadiusSquared = FMath::Square(ComponentStreamingRadius + ComponentStreamingHysteresis);
+
+	TArray<TPair<double, URuntimeLandscapeComponent*>> ComponentsToStreamIn;
+	for (URuntimeLandscapeComponent* Component : LandscapeComponents)
+	{
+		if (!Component)
+		{
+			continue;
+		}
+
+		const FBox2D ComponentBounds = GetComponentBounds(Component->GetComponentIndex()).ShiftBy(Origin);
+		double DistanceSquared = TNumericLimits<double>::Max();
+		for (const FVector& ViewLocation : ViewLocations)
+		{
+			DistanceSquared = FMath::Min(DistanceSquared,
+			                             ComponentBounds.ComputeSquaredDistanceToPoint(FVector2D(ViewLocation)));
+		}
+
+		if (!Component->IsStreamedIn() && DistanceSquared <= StreamInRadiusSquared)
+		{
+			ComponentsToStreamIn.Emplace(DistanceSquared, Component);
+		}
+		else if (Component->IsStreamedIn() && DistanceSquared > StreamOutRadiusSquared)
+		{
+			Component->SetStreamedIn(false);
+		}
+	}
+
+	if (ComponentsToStreamIn.IsEmpty())
+	{
+		return;
+	}
+
+	// components are rebuilt in queue order, so the nearest components are queued first
+	// they are queued like regular rebuilds, bulk builds are reserved for building the whole landscape
+	ComponentsToStreamIn.Sort([](const TPair<double, URuntimeLandscapeComponent*>& A,
+	                             const TPair<double, URuntimeLandscapeComponent*>& B)
+	{
+		return A.Key < B.Key;
+	});
+
+	for (const TPair<double, URuntimeLandscapeComponent*>& Entry : ComponentsToStreamIn)
+	{
+		Entry.Value->SetStreamedIn(true);
+	}
 }
 
 void ARuntimeLandscape::BakeLandscapeLayers()
 {
+	UpdateGroundTypeLayerIndices();
+
 	if (ParentLandscape)
 	{
 		FBox2D Box2D = FBox2D();
 
-		for (FRuntimeLandscapeGroundTypeLayerSet& LayerSet : GroundLayerSets)
+		for (int32 LayerSetIndex = 0; LayerSetIndex < GroundLayerSets.Num(); ++LayerSetIndex)
 		{
+			FRuntimeLandscapeGroundTypeLayerSet& LayerSet = GroundLayerSets[LayerSetIndex];
 			const TArray<FName>& LayerNames = LayerSet.GetLayerNames();
 			if (LayerSet.RenderTarget)
 			{
@@ -332,13 +995,108 @@ void ARuntimeLandscape::BakeLandscapeLayers()
 				ParentLandscape->RenderWeightmaps(GetActorTransform(), Box2D, LayerNames,
 				                                  LayerSet.RenderTarget);
 
-				UpdateVertexLayerWeights(LayerSet);
+				UpdateVertexLayerWeights(LayerSetIndex);
 			}
 		}
 	}
 }
 
 void ARuntimeLandscape::Rebuild()
+{
+	const TArray<TObjectPtr<ULandscapeHeightfieldCollisionComponent>>& CollisionComponents = ParentLandscape->
+		CollisionComponents;
+	const int32 VertexAmountPerSection = GetTotalVertexAmountPerComponent();
+
+	FVector ParentOrigin;
+	FVector ParentExtent;
+	ParentLandscape->GetActorBounds(false, ParentOrigin, ParentExtent);
+	const FVector StartLocation = ParentOrigin - ParentExtent;
+
+	// the height fields are only read, so all components can be extracted at once
+	TArray<TArray<float>> ComponentHeightValues;
+	TArray<FVector> ComponentLocations;
+	ComponentHeightValues.SetNum(CollisionComponents.Num());
+	ComponentLocations.SetNum(CollisionComponents.Num());
+	ParallelFor(CollisionComponents.Num(), [&](int32 CollisionIndex)
+	{
+		const ULandscapeHeightfieldCollisionComponent* LandscapeCollision = CollisionComponents[CollisionIndex];
+
+		// calculate index by position for more efficient access later
+		const FVector ComponentLocation = LandscapeCollision->GetComponentLocation() - StartLocation;
+		const int32 ComponentIndex = ComponentLocation.X / ComponentSize + ComponentLocation.Y / ComponentSize *
+			ComponentAmount.X;
+		ComponentLocations[ComponentIndex] = LandscapeCollision->GetComponentLocation();
+
+		Chaos::FHeightFieldPtr HeightField = LandscapeCollision->HeightfieldRef->HeightfieldGeometry;
+		TArray<float>& HeightValues = ComponentHeightValues[ComponentIndex];
+		HeightValues.SetNumUninitialized(VertexAmountPerSection);
+		for (int32 i = 0; i < VertexAmountPerSection; i++)
+		{
+			HeightValues[i] = HeightField->GetHeight(i) * HeightScale;
+		}
+	});
+
+	CreateComponents(ComponentHeightValues, ComponentLocations);
+}
+
+void ARuntimeLandscape::InitializeFromHeightmap(const FIntPoint& InComponentAmount, int32 ComponentSizeQuads,
+                                                float InQuadSideLength, const TArray<float>& Heights)
+{
+	const FIntPoint QuadAmount = InComponentAmount * ComponentSizeQuads;
+	if (!ensure(InComponentAmount.X > 0 && InComponentAmount.Y > 0 && ComponentSizeQuads > 0)
+		|| !ensure(Heights.Num() == (QuadAmount.X + 1) * (QuadAmount.Y + 1)))
+	{
+		return;
+	}
+
+	// same layout as a landscape with default scale
+	HeightScale = 100.0f / FMath::Pow(2.0f, HeightValueBits);
+	ParentHeight = GetActorLocation().Z;
+	MeshResolution = FVector2D(QuadAmount.X, QuadAmount.Y);
+	QuadSideLength = InQuadSideLength;
+	LandscapeSize = MeshResolution * QuadSideLength;
+	ComponentSize = ComponentSizeQuads * QuadSideLength;
+	AreaPerSquare = FMath::Square(QuadSideLength);
+	ComponentAmount = FVector2D(InComponentAmount.X, InComponentAmount.Y);
+	ComponentResolution = MeshResolution / ComponentAmount;
+	VertexAmountPerComponent.X = ComponentSizeQuads + 1;
+	VertexAmountPerComponent.Y = ComponentSizeQuads + 1;
+
+	// components share their border vertices
+	const int32 ComponentCount = InComponentAmount.X * InComponentAmount.Y;
+	TArray<TArray<float>> ComponentHeightValues;
+	TArray<FVector> ComponentLocations;
+	ComponentHeightValues.SetNum(ComponentCount);
+	ComponentLocations.SetNum(ComponentCount);
+	for (int32 ComponentIndex = 0; ComponentIndex < ComponentCount; ++ComponentIndex)
+	{
+		const FIntPoint FirstVertex(ComponentIndex % InComponentAmount.X * ComponentSizeQuads,
+		                            ComponentIndex / InComponentAmount.X * ComponentSizeQuads);
+		ComponentLocations[ComponentIndex] = GetActorLocation() + FVector(FVector2D(FirstVertex) * QuadSideLength, 0.0);
+
+		TArray<float>& HeightValues = ComponentHeightValues[ComponentIndex];
+		HeightValues.SetNumUninitialized(GetTotalVertexAmountPerComponent());
+		int32 VertexIndex = 0;
+		for (int32 Y = 0; Y < VertexAmountPerComponent.Y; ++Y)
+		{
+			for (int32 X = 0; X < VertexAmountPerComponent.X; ++X)
+			{
+				HeightValues[VertexIndex++] = Heights[FirstVertex.X + X + (FirstVertex.Y + Y) * (QuadAmount.X + 1)];
+			}
+		}
+	}
+
+	CreateComponents(ComponentHeightValues, ComponentLocations);
+
+	// the landscape was registered with its previous size, so layers would not resolve it
+	if (URuntimeLandscapeSubsystem* Subsystem = GetWorld()->GetSubsystem<URuntimeLandscapeSubsystem>())
+	{
+		Subsystem->RegisterLandscape(this);
+	}
+}
+
+void ARuntimeLandscape::CreateComponents(const TArray<TArray<float>>& ComponentHeightValues,
+                                         const TArray<FVector>& ComponentLocations)
 {
 	TArray<UHierarchicalInstancedStaticMeshComponent*> InstancedMeshes;
 	GetComponents(InstancedMeshes);
@@ -347,7 +1105,7 @@ void ARuntimeLandscape::Rebuild()
 		InstancedMesh->DestroyComponent();
 	}
 
-	BakeLandscapeLayers();
+	GrassClusters.Empty();
 
 	// clean up old components but remember existing layers
 	TSet<TObjectPtr<const ULandscapeLayerComponent>> LandscapeLayers;
@@ -360,57 +1118,63 @@ void ARuntimeLandscape::Rebuild()
 		}
 	}
 
-	BodyInstance = FBodyInstance();
-	BodyInstance.CopyBodyInstancePropertiesFrom(&ParentLandscape->BodyInstance);
-	bGenerateOverlapEvents = ParentLandscape->bGenerateOverlapEvents;
+	if (ParentLandscape)
+	{
+		BodyInstance = FBodyInstance();
+		BodyInstance.CopyBodyInstancePropertiesFrom(&ParentLandscape->BodyInstance);
+		bGenerateOverlapEvents = ParentLandscape->bGenerateOverlapEvents;
+	}
 
 	// create landscape components
-	LandscapeComponents.SetNumUninitialized(ParentLandscape->CollisionComponents.Num());
-	const int32 VertexAmountPerSection = GetTotalVertexAmountPerComponent();
+	LandscapeComponents.SetNumUninitialized(ComponentHeightValues.Num());
 
-	for (const ULandscapeHeightfieldCollisionComponent* LandscapeCollision : ParentLandscape->CollisionComponents)
+	// center the 16 bit height storage on the source heights, so layers can raise and lower the terrain equally
+	float MinHeight = MAX_flt;
+	float MaxHeight = -MAX_flt;
+	for (const TArray<float>& HeightValues : ComponentHeightValues)
 	{
-		Chaos::FHeightFieldPtr HeightField = LandscapeCollision->HeightfieldRef->HeightfieldGeometry;
-		TArray<float> HeightValues = TArray<float>();
-		HeightValues.Reserve(VertexAmountPerSection);
-		for (int32 i = 0; i < VertexAmountPerSection; i++)
+		for (const float Height : HeightValues)
 		{
-			HeightValues.Add(HeightField->GetHeight(i) * HeightScale);
+			MinHeight = FMath::Min(MinHeight, Height);
+			MaxHeight = FMath::Max(MaxHeight, Height);
 		}
+	}
+
+	const float CenterHeight = MinHeight <= MaxHeight ? (MinHeight + MaxHeight) * 0.5f : 0.0f;
+	HeightOffset = ParentHeight + CenterHeight - (MAX_uint16 / 2 + 1) * HeightScale;
 
+	// all components are rebuilt concurrently once layers and weights are set up
+	RebuildManager->BeginBulkBuild();
+	for (int32 ComponentIndex = 0; ComponentIndex < ComponentHeightValues.Num(); ++ComponentIndex)
+	{
 		URuntimeLandscapeComponent* LandscapeComponent = NewObject<URuntimeLandscapeComponent>(this);
 		LandscapeComponent->AttachToComponent(RootComponent, FAttachmentTransformRules::KeepRelativeTransform);
-		LandscapeComponent->SetWorldLocation(LandscapeCollision->GetComponentLocation());
+		LandscapeComponent->SetWorldLocation(ComponentLocations[ComponentIndex]);
 		LandscapeComponent->SetMaterial(0, LandscapeMaterial);
 		LandscapeComponent->SetGenerateOverlapEvents(bGenerateOverlapEvents);
 		LandscapeComponent->SetCastShadow(bCastShadow);
 		LandscapeComponent->SetAffectDistanceFieldLighting(bAffectDistanceFieldLighting);
 
 		LandscapeComponent->BodyInstance = FBodyInstance();
-		LandscapeComponent->BodyInstance.CopyBodyInstancePropertiesFrom(&ParentLandscape->BodyInstance);
+		LandscapeComponent->BodyInstance.CopyBodyInstancePropertiesFrom(&BodyInstance);
 		LandscapeComponent->SetGenerateOverlapEvents(bGenerateOverlapEvents);
 		LandscapeComponent->SetCanEverAffectNavigation(bCanEverAffectNavigation);
 
-		FVector ParentOrigin;
-		FVector ParentExtent;
-		ParentLandscape->GetActorBounds(false, ParentOrigin, ParentExtent);
-
-		// calculate index by position for more efficient access later
-		const FVector StartLocation = ParentOrigin - ParentExtent;
-		const FVector ComponentLocation = LandscapeComponent->GetComponentLocation() - StartLocation;
-		const int32 ComponentIndex = ComponentLocation.X / ComponentSize + ComponentLocation.Y / ComponentSize *
-			ComponentAmount.X;
-
-		LandscapeComponent->Initialize(ComponentIndex, HeightValues);
+		LandscapeComponent->Initialize(ComponentIndex, ComponentHeightValues[ComponentIndex]);
 		LandscapeComponent->RegisterComponent();
 		LandscapeComponents[ComponentIndex] = LandscapeComponent;
 	}
 
+	// weights are stored in the components, so they can only be baked after the components are created
+	BakeLandscapeLayers();
+
 	// add remembered layers
 	for (TObjectPtr<const ULandscapeLayerComponent> Layer : LandscapeLayers)
 	{
 		AddLandscapeLayer(Layer);
 	}
+
+	RebuildManager->EndBulkBuild();
 }
 
 #if WITH_EDITORONLY_DATA
@@ -449,6 +1213,59 @@ void ARuntimeLandscape::InitializeFromLandscape()
 	Rebuild();
 }
 
+void ARuntimeLandscape::ConvertDeprecatedHeights()
+{
+	float MinHeight = MAX_flt;
+	float MaxHeight = -MAX_flt;
+	for (const URuntimeLandscapeComponent* Component : LandscapeComponents)
+	{
+		if (Component)
+		{
+			for (const float Height : Component->InitialHeightValues_DEPRECATED)
+			{
+				MinHeight = FMath::Min(MinHeight, Height);
+				MaxHeight = FMath::Max(MaxHeight, Height);
+			}
+		}
+	}
+
+	if (MinHeight > MaxHeight)
+	{
+		return;
+	}
+
+	// same range as in Rebuild, the deprecated heights already include the parent height
+	HeightOffset = (MinHeight + MaxHeight) * 0.5f - (MAX_uint16 / 2 + 1) * HeightScale;
+	for (URuntimeLandscapeComponent* Component : LandscapeComponents)
+	{
+		if (Component && Component->InitialHeightValues_DEPRECATED.IsEmpty() == false)
+		{
+			const TArray<float>& DeprecatedHeights = Component->InitialHeightValues_DEPRECATED;
+			Component->InitialHeights.SetNumUninitialized(DeprecatedHeights.Num());
+			for (int32 i = 0; i < DeprecatedHeights.Num(); ++i)
+			{
+				Component->InitialHeights[i] = QuantizeHeight(DeprecatedHeights[i]);
+			}
+
+			Component->InitialHeightValues_DEPRECATED.Empty();
+		}
+	}
+}
+
+void ARuntimeLandscape::ConvertDeprecatedGroundTypeBrushes()
+{
+	if (GroundTypeBrushes_DEPRECATED.IsEmpty())
+	{
+		return;
+	}
+
+	// the shapes are rasterized on the CPU, so the materials have no equivalent and are only released
+	UE_LOG(RuntimeEditableLandscape, Display,
+	       TEXT("%s: Ground type brush materials are no longer used, the brushes are rasterized on the CPU."),
+	       *GetName());
+	GroundTypeBrushes_DEPRECATED.Empty();
+}
+
 void ARuntimeLandscape::PreInitializeComponents()
 {
 	Super::PreInitializeComponents();
@@ -480,6 +1297,33 @@ void ARuntimeLandscape::PostEditChangeProperty(FPropertyChangedEvent& PropertyCh
 		InitializeFromLandscape();
 	}
 
+	if (PropertyChangedEvent.MemberProperty->GetName() == FName("GroundLayerSets")
+		|| PropertyChangedEvent.MemberProperty->GetName() == FName("AdditionalGroundTypes"))
+	{
+		BakeLandscapeLayers();
+	}
+
+	if (PropertyChangedEvent.MemberProperty->GetName() == FName("HeightBasedData"))
+	{
+		UpdateGrassRules();
+	}
+
+	if (PropertyChangedEvent.MemberProperty->GetName() == FName("bUseMeshCache"))
+	{
+		// don't keep unused caches in the level
+		for (URuntimeLandscapeComponent* Component : LandscapeComponents)
+		{
+			if (bUseMeshCache)
+			{
+				Component->Rebuild();
+			}
+			else
+			{
+				Component->MeshCache.Reset();
+			}
+		}
+	}
+
 	if (PropertyChangedEvent.MemberProperty->GetName() == FName("bGenerateOverlapEvents"))
 	{
 		for (URuntimeLandscapeComponent* Component : LandscapeComponents)
@@ -0,0 +1,411 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RuntimeLandscapeBenchmarkCommandlet.h"
+
+#if WITH_EDITOR
+#include "LandscapeGroundTypeData.h"
+#include "LandscapeLayerComponent.h"
+#include "RuntimeLandscape.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Components/BoxComponent.h"
+#include "Containers/Ticker.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "LayerTypes/LandscapeGroundTypeLayerData.h"
+#include "LayerTypes/LandscapeHeightLayerData.h"
+#include "LayerTypes/LandscapeHoleLayerData.h"
+#include "LayerTypes/LandscapeVertexColorLayerData.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Threads/RuntimeLandscapeRebuildManager.h"
+
+namespace RuntimeLandscapeBenchmark
+{
+	enum ELayerType : int32
+	{
+		LT_Height,
+		LT_Hole,
+		LT_VertexColor,
+		LT_GroundType,
+		LT_Num
+	};
+
+	const TCHAR* const LayerTypeNames[] = {TEXT("Height"), TEXT("Hole"), TEXT("VertexColor"), TEXT("GroundType")};
+	static_assert(UE_ARRAY_COUNT(LayerTypeNames) == LT_Num);
+
+	/** The amount of ground types that are painted by ground type layers */
+	constexpr int32 GroundTypeAmount = 4;
+}
+
+URuntimeLandscapeBenchmarkCommandlet::URuntimeLandscapeBenchmarkCommandlet() : Super(),
+	PeakTrackedMemory(InPlace, 0)
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Benchmark the rebuilds of a synthetic runtime landscape");
+	HelpUsage = TEXT("-run=RuntimeLandscapeBenchmark -nullrhi [-ComponentAmount=8] [-ComponentQuads=63] "
+		"[-QuadSize=100] [-Batches=16] [-LayersPerBatch=8] [-Seed=0] [-FrameRate=60] [-Timeout=300] [-Output=<Path>]");
+}
+
+int32 URuntimeLandscapeBenchmarkCommandlet::Main(const FString& Params)
+{
+	using namespace RuntimeLandscapeBenchmark;
+
+	int32 ComponentAmount = 8;
+	int32 ComponentQuads = 63;
+	float QuadSize = 100.0f;
+	int32 BatchAmount = 16;
+	int32 LayersPerBatch = 8;
+	int32 Seed = 0;
+	float FrameRate = 60.0f;
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(
+		TEXT("RuntimeLandscape-%s.json"), *FDateTime::Now().ToString());
+	FParse::Value(*Params, TEXT("ComponentAmount="), ComponentAmount);
+	FParse::Value(*Params, TEXT("ComponentQuads="), ComponentQuads);
+	FParse::Value(*Params, TEXT("QuadSize="), QuadSize);
+	FParse::Value(*Params, TEXT("Batches="), BatchAmount);
+	FParse::Value(*Params, TEXT("LayersPerBatch="), LayersPerBatch);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("FrameRate="), FrameRate);
+	FParse::Value(*Params, TEXT("Timeout="), Timeout);
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	if (ComponentAmount <= 0 || ComponentQuads <= 0 || QuadSize <= 0.0f || BatchAmount < 0 || LayersPerBatch <= 0)
+	{
+		UE_LOG(RuntimeEditableLandscape, Error, TEXT("Invalid benchmark parameters. Usage: %s"), *HelpUsage);
+		return 1;
+	}
+
+	FrameTime = FrameRate > 0.0f ? 1.0 / FrameRate : 0.0;
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("RuntimeLandscapeBenchmark"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	// there is no game mode that would begin play
+	World->GetWorldSettings()->NotifyBeginPlay();
+
+	TArray<TObjectPtr<const ULandscapeGroundTypeData>> GroundTypes;
+	for (int32 GroundTypeIndex = 0; GroundTypeIndex < GroundTypeAmount; ++GroundTypeIndex)
+	{
+		ULandscapeGroundTypeData* GroundType = NewObject<ULandscapeGroundTypeData>(GetTransientPackage());
+		GroundType->LandscapeLayerName = *FString::Printf(TEXT("BenchmarkGroundType%i"), GroundTypeIndex);
+		GroundTypes.Add(GroundType);
+	}
+
+	ARuntimeLandscape* Landscape = World->SpawnActorDeferred<ARuntimeLandscape>(
+		ARuntimeLandscape::StaticClass(), FTransform::Identity);
+	Landscape->SetAdditionalGroundTypes(GroundTypes);
+	Landscape->FinishSpawning(FTransform::Identity);
+
+	// rolling hills with noise, so the heights are not uniform
+	FRandomStream Random(Seed);
+	const int32 VertexAmount = ComponentAmount * ComponentQuads + 1;
+	const float LandscapeSize = (VertexAmount - 1) * QuadSize;
+	TArray<float> Heights;
+	Heights.SetNumUninitialized(VertexAmount * VertexAmount);
+	for (int32 Y = 0; Y < VertexAmount; ++Y)
+	{
+		for (int32 X = 0; X < VertexAmount; ++X)
+		{
+			Heights[X + Y * VertexAmount] = FMath::Sin(X * 0.05f) * FMath::Cos(Y * 0.04f) * 1500.0f
+				+ FMath::Sin((X + Y) * 0.013f) * 800.0f + Random.FRandRange(-20.0f, 20.0f);
+		}
+	}
+
+	const URuntimeLandscapeRebuildManager* RebuildManager = Landscape->GetRebuildManager();
+	const int32 TotalComponentAmount = ComponentAmount * ComponentAmount;
+	UE_LOG(RuntimeEditableLandscape, Display, TEXT("Building %i components with %i quads each"),
+	       TotalComponentAmount, ComponentQuads * ComponentQuads);
+
+	FRuntimeEditableLandscapeModule::ResetStageTimings();
+	FRuntimeEditableLandscapeModule::SetStageTimingsEnabled(true);
+	const double InitialBuildStart = FPlatformTime::Seconds();
+	Landscape->InitializeFromHeightmap(FIntPoint(ComponentAmount), ComponentQuads, QuadSize, Heights);
+	bool bIsTimedOut = !TickUntilIdle(World, Landscape);
+	const double InitialBuildSeconds = FPlatformTime::Seconds() - InitialBuildStart;
+	const TSharedRef<FJsonObject> InitialBuildStages = CreateStageReport();
+
+	// only the edits are measured from here on
+	FRuntimeEditableLandscapeModule::ResetStageTimings();
+	Landscape->ResetEditLatency();
+
+	TArray<TSharedPtr<FJsonValue>> BatchReports;
+	TArray<AActor*> LayerActors;
+	int32 TotalLayerAmount = 0;
+	int32 TotalRebuiltComponents = 0;
+	double TotalBatchSeconds = 0.0;
+	for (int32 Batch = 0; Batch < BatchAmount && !bIsTimedOut; ++Batch)
+	{
+		const int32 FinishedRebuildsBefore = RebuildManager->GetFinishedRebuildAmount();
+		const double BatchStart = FPlatformTime::Seconds();
+
+		// removing the layers of the previous batch rebuilds their components as well
+		for (AActor* LayerActor : LayerActors)
+		{
+			LayerActor->Destroy();
+		}
+
+		LayerActors.Reset();
+		for (int32 LayerIndex = 0; LayerIndex < LayersPerBatch; ++LayerIndex)
+		{
+			const FVector Extent(Random.FRandRange(2.0f, 12.0f) * QuadSize, Random.FRandRange(2.0f, 12.0f) * QuadSize,
+			                     100.0f);
+			const FVector Location(Random.FRandRange(Extent.X, LandscapeSize - Extent.X),
+			                       Random.FRandRange(Extent.Y, LandscapeSize - Extent.Y),
+			                       Random.FRandRange(-500.0f, 500.0f));
+			LayerActors.Add(SpawnLayer(World, (Batch * LayersPerBatch + LayerIndex) % LT_Num, Location, Extent,
+			                           GroundTypes[Random.RandHelper(GroundTypes.Num())], Random));
+		}
+
+		bIsTimedOut = !TickUntilIdle(World, Landscape);
+		const double BatchSeconds = FPlatformTime::Seconds() - BatchStart;
+		const int32 RebuiltComponents = RebuildManager->GetFinishedRebuildAmount() - FinishedRebuildsBefore;
+		TotalLayerAmount += LayersPerBatch;
+		TotalRebuiltComponents += RebuiltComponents;
+		TotalBatchSeconds += BatchSeconds;
+
+		const TSharedRef<FJsonObject> BatchReport = MakeShared<FJsonObject>();
+		BatchReport->SetNumberField(TEXT("Seconds"), BatchSeconds);
+		BatchReport->SetNumberField(TEXT("RebuiltComponents"), RebuiltComponents);
+		BatchReport->SetNumberField(TEXT("LayersPerSecond"), LayersPerBatch / BatchSeconds);
+		BatchReport->SetNumberField(TEXT("ComponentsPerSecond"), RebuiltComponents / BatchSeconds);
+		BatchReports.Add(MakeShared<FJsonValueObject>(BatchReport));
+
+		UE_LOG(RuntimeEditableLandscape, Display, TEXT("Batch %i: %i layers, %i components in %.3f seconds"), Batch,
+		       LayersPerBatch, RebuiltComponents, BatchSeconds);
+	}
+
+	FRuntimeEditableLandscapeModule::SetStageTimingsEnabled(false);
+
+	// write the report
+	const TSharedRef<FJsonObject> Config = MakeShared<FJsonObject>();
+	Config->SetNumberField(TEXT("ComponentAmount"), ComponentAmount);
+	Config->SetNumberField(TEXT("ComponentQuads"), ComponentQuads);
+	Config->SetNumberField(TEXT("QuadSize"), QuadSize);
+	Config->SetNumberField(TEXT("Batches"), BatchAmount);
+	Config->SetNumberField(TEXT("LayersPerBatch"), LayersPerBatch);
+	Config->SetNumberField(TEXT("Seed"), Seed);
+	Config->SetNumberField(TEXT("FrameRate"), FrameRate);
+	Config->SetNumberField(TEXT("WorkerThreads"), FPlatformMisc::NumberOfWorkerThreadsToSpawn());
+	TArray<TSharedPtr<FJsonValue>> LayerTypes;
+	for (const TCHAR* LayerTypeName : LayerTypeNames)
+	{
+		LayerTypes.Add(MakeShared<FJsonValueString>(LayerTypeName));
+	}
+
+	Config->SetArrayField(TEXT("LayerTypes"), LayerTypes);
+
+	const TSharedRef<FJsonObject> InitialBuild = MakeShared<FJsonObject>();
+	InitialBuild->SetNumberField(TEXT("Seconds"), InitialBuildSeconds);
+	InitialBuild->SetNumberField(TEXT("ComponentsPerSecond"), TotalComponentAmount / InitialBuildSeconds);
+	InitialBuild->SetObjectField(TEXT("Stages"), InitialBuildStages);
+
+	const TSharedRef<FJsonObject> Edits = MakeShared<FJsonObject>();
+	Edits->SetNumberField(TEXT("Seconds"), TotalBatchSeconds);
+	Edits->SetNumberField(TEXT("Layers"), TotalLayerAmount);
+	Edits->SetNumberField(TEXT("RebuiltComponents"), TotalRebuiltComponents);
+	Edits->SetNumberField(TEXT("LayersPerSecond"),
+	                      TotalBatchSeconds > 0.0 ? TotalLayerAmount / TotalBatchSeconds : 0.0);
+	Edits->SetNumberField(TEXT("ComponentsPerSecond"),
+	                      TotalBatchSeconds > 0.0 ? TotalRebuiltComponents / TotalBatchSeconds : 0.0);
+	Edits->SetArrayField(TEXT("Batches"), BatchReports);
+	Edits->SetObjectField(TEXT("Stages"), CreateStageReport());
+
+	float P50, P95, P99;
+	const int32 EditAmount = Landscape->GetEditLatencyPercentiles(P50, P95, P99);
+	const TSharedRef<FJsonObject> Latency = MakeShared<FJsonObject>();
+	Latency->SetNumberField(TEXT("Edits"), EditAmount);
+	Latency->SetNumberField(TEXT("P50Ms"), P50);
+	Latency->SetNumberField(TEXT("P95Ms"), P95);
+	Latency->SetNumberField(TEXT("P99Ms"), P99);
+	Latency->SetNumberField(TEXT("MaxMs"), Landscape->GetEditTracker().GetLatency().GetMaxLatency());
+	Edits->SetObjectField(TEXT("Latency"), Latency);
+
+	const TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetObjectField(TEXT("Config"), Config);
+	Report->SetBoolField(TEXT("TimedOut"), bIsTimedOut);
+	Report->SetObjectField(TEXT("InitialBuild"), InitialBuild);
+	Report->SetObjectField(TEXT("Edits"), Edits);
+	Report->SetObjectField(TEXT("Memory"), CreateMemoryReport());
+
+	for (AActor* LayerActor : LayerActors)
+	{
+		LayerActor->Destroy();
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	FString ReportString;
+	FJsonSerializer::Serialize(Report, TJsonWriterFactory<>::Create(&ReportString));
+	if (!FFileHelper::SaveStringToFile(ReportString, *OutputPath))
+	{
+		UE_LOG(RuntimeEditableLandscape, Error, TEXT("Could not write the benchmark report to %s"), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(RuntimeEditableLandscape, Display, TEXT("Wrote the benchmark report to %s"), *OutputPath);
+	return bIsTimedOut ? 1 : 0;
+}
+
+bool URuntimeLandscapeBenchmarkCommandlet::TickUntilIdle(UWorld* World, const ARuntimeLandscape* Landscape)
+{
+	const URuntimeLandscapeRebuildManager* RebuildManager = Landscape->GetRebuildManager();
+	const double StartTime = FPlatformTime::Seconds();
+	double LastFrameTime = StartTime;
+	float DeltaSeconds = FrameTime > 0.0 ? FrameTime : 1.0f / 60.0f;
+	do
+	{
+		World->Tick(LEVELTICK_All, DeltaSeconds);
+		FTSTicker::GetCoreTicker().Tick(DeltaSeconds);
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+		++GFrameCounter;
+		SampleMemory();
+
+		// pace the frames like a game, so rebuilds that are spread across frames are measured realistically
+		double Now = FPlatformTime::Seconds();
+		if (Now - LastFrameTime < FrameTime)
+		{
+			FPlatformProcess::Sleep(static_cast<float>(FrameTime - (Now - LastFrameTime)));
+			Now = FPlatformTime::Seconds();
+		}
+
+		DeltaSeconds = static_cast<float>(Now - LastFrameTime);
+		LastFrameTime = Now;
+
+		if (Now - StartTime > Timeout)
+		{
+			UE_LOG(RuntimeEditableLandscape, Error, TEXT("The landscape did not finish rebuilding in %.0f seconds"),
+			       Timeout);
+			return false;
+		}
+	}
+	while (RebuildManager->IsRebuilding());
+
+	return true;
+}
+
+void URuntimeLandscapeBenchmarkCommandlet::SampleMemory()
+{
+	int64 TotalTrackedMemory = 0;
+	for (int32 Type = 0; Type < static_cast<int32>(ERuntimeLandscapeMemory::Num); ++Type)
+	{
+		const int64 Memory = FRuntimeEditableLandscapeModule::GetTrackedMemory(
+			static_cast<ERuntimeLandscapeMemory>(Type));
+		PeakTrackedMemory[Type] = FMath::Max(PeakTrackedMemory[Type], Memory);
+		TotalTrackedMemory += Memory;
+	}
+
+	PeakTotalTrackedMemory = FMath::Max(PeakTotalTrackedMemory, TotalTrackedMemory);
+}
+
+AActor* URuntimeLandscapeBenchmarkCommandlet::SpawnLayer(UWorld* World, int32 LayerType, const FVector& Location,
+                                                         const FVector& Extent,
+                                                         const ULandscapeGroundTypeData* GroundType,
+                                                         FRandomStream& Random) const
+{
+	using namespace RuntimeLandscapeBenchmark;
+
+	AActor* LayerActor = World->SpawnActor<AActor>();
+	// ground type layers paint the area of the box
+	UBoxComponent* Box = NewObject<UBoxComponent>(LayerActor);
+	Box->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Box->SetBoxExtent(Extent);
+	LayerActor->SetRootComponent(Box);
+	Box->SetWorldLocation(Location);
+	Box->RegisterComponent();
+
+	ULandscapeLayerComponent* LayerComponent = NewObject<ULandscapeLayerComponent>(LayerActor);
+	LayerComponent->SetBoxExtent(Extent);
+	LayerComponent->SmoothingDistance = FMath::Min(Extent.X, Extent.Y) * 0.5f;
+
+	ULandscapeLayerDataBase* LayerData = nullptr;
+	switch (LayerType)
+	{
+	case LT_Height:
+		{
+			ULandscapeHeightLayerData* HeightLayer = NewObject<ULandscapeHeightLayerData>(LayerComponent);
+			HeightLayer->SetHeightValue(Random.FRandRange(-300.0f, 300.0f));
+			LayerData = HeightLayer;
+			break;
+		}
+	case LT_Hole:
+		LayerData = NewObject<ULandscapeHoleLayerData>(LayerComponent);
+		break;
+	case LT_VertexColor:
+		{
+			ULandscapeVertexColorLayerData* VertexColorLayer = NewObject<ULandscapeVertexColorLayerData>(
+				LayerComponent);
+			VertexColorLayer->SetVertexColor(FColor::MakeRandomSeededColor(Random.RandHelper(MAX_int32)));
+			LayerData = VertexColorLayer;
+			break;
+		}
+	case LT_GroundType:
+		{
+			ULandscapeGroundTypeLayerData* GroundTypeLayer = NewObject<ULandscapeGroundTypeLayerData>(
+				LayerComponent);
+			GroundTypeLayer->SetGroundType(GroundType);
+			LayerData = GroundTypeLayer;
+			break;
+		}
+	default:
+		checkNoEntry();
+	}
+
+	LayerComponent->AddLayerData(LayerData);
+	LayerActor->AddInstanceComponent(LayerComponent);
+	// the actor already began play, so registering begins play of the layer, which applies it
+	LayerComponent->RegisterComponent();
+
+	return LayerActor;
+}
+
+TSharedRef<FJsonObject> URuntimeLandscapeBenchmarkCommandlet::CreateStageReport() const
+{
+	const TSharedRef<FJsonObject> Stages = MakeShared<FJsonObject>();
+	for (int32 StageIndex = 0; StageIndex < static_cast<int32>(ERuntimeLandscapeStage::Num); ++StageIndex)
+	{
+		const ERuntimeLandscapeStage Stage = static_cast<ERuntimeLandscapeStage>(StageIndex);
+		double Seconds;
+		int64 Calls;
+		FRuntimeEditableLandscapeModule::GetStageTiming(Stage, Seconds, Calls);
+
+		const TSharedRef<FJsonObject> StageReport = MakeShared<FJsonObject>();
+		StageReport->SetNumberField(TEXT("Seconds"), Seconds);
+		StageReport->SetNumberField(TEXT("Calls"), Calls);
+		StageReport->SetNumberField(TEXT("MsPerCall"), Calls > 0 ? Seconds * 1000.0 / Calls : 0.0);
+		Stages->SetObjectField(FRuntimeEditableLandscapeModule::GetStageName(Stage), StageReport);
+	}
+
+	return Stages;
+}
+
+TSharedRef<FJsonObject> URuntimeLandscapeBenchmarkCommandlet::CreateMemoryReport() const
+{
+	static const TCHAR* MemoryNames[] = {TEXT("Heights"), TEXT("GroundTypeWeights"), TEXT("Grass"),
+		TEXT("RebuildBuffers")};
+	static_assert(UE_ARRAY_COUNT(MemoryNames) == static_cast<int32>(ERuntimeLandscapeMemory::Num));
+
+	const TSharedRef<FJsonObject> Memory = MakeShared<FJsonObject>();
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+	Memory->SetNumberField(TEXT("PeakUsedPhysicalMB"), MemoryStats.PeakUsedPhysical / 1048576.0);
+	Memory->SetNumberField(TEXT("PeakUsedVirtualMB"), MemoryStats.PeakUsedVirtual / 1048576.0);
+	Memory->SetNumberField(TEXT("PeakTrackedMB"), PeakTotalTrackedMemory / 1048576.0);
+	for (int32 Type = 0; Type < static_cast<int32>(ERuntimeLandscapeMemory::Num); ++Type)
+	{
+		Memory->SetNumberField(FString::Printf(TEXT("Peak%sMB"), MemoryNames[Type]),
+		                       PeakTrackedMemory[Type] / 1048576.0);
+	}
+
+	return Memory;
+}
+
+#endif
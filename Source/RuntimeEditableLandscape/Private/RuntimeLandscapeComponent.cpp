@@ -8,14 +8,37 @@
 #include "NavigationSystem.h"
 #include "RuntimeEditableLandscape.h"
 #include "RuntimeLandscape.h"
+#include "AI/NavigationSystemHelpers.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
 #include "LayerTypes/LandscapeHoleLayerData.h"
 #include "LayerTypes/LandscapeLayerDataBase.h"
 #include "Runtime/Foliage/Public/InstancedFoliageActor.h"
 #include "Threads/RuntimeLandscapeRebuildManager.h"
 
+URuntimeLandscapeComponent::URuntimeLandscapeComponent() : Super()
+{
+	bHasCustomNavigableGeometry = EHasCustomNavigableGeometry::Yes;
+}
+
 void URuntimeLandscapeComponent::AddLandscapeLayer(const ULandscapeLayerComponent* Layer)
 {
 	AffectingLayers.Add(Layer);
+	AffectingLayerBounds.Add(Layer, Layer->GetBoundingBox());
+	FoliageDirtyArea += Layer->GetBoundingBox();
+	Rebuild();
+}
+
+void URuntimeLandscapeComponent::RemoveLandscapeLayer(const ULandscapeLayerComponent* Layer)
+{
+	// components that were not affected by the layer don't change
+	if (AffectingLayers.Remove(Layer) == 0)
+	{
+		return;
+	}
+
+	const FBox2D* LayerBounds = AffectingLayerBounds.Find(Layer);
+	FoliageDirtyArea += LayerBounds ? *LayerBounds : Layer->GetBoundingBox();
+	AffectingLayerBounds.Remove(Layer);
 	Rebuild();
 }
 
@@ -24,10 +47,11 @@ void URuntimeLandscapeComponent::Initialize(int32 ComponentIndex, const TArray<f
 	ParentLandscape = Cast<ARuntimeLandscape>(GetOwner());
 	if (ensure(ParentLandscape))
 	{
-		InitialHeightValues.SetNumUninitialized(HeightValuesInitial.Num());
+		InitialHeights.SetNumUninitialized(HeightValuesInitial.Num());
 		for (int32 i = 0; i < HeightValuesInitial.Num(); i++)
 		{
-			InitialHeightValues[i] = HeightValuesInitial[i] + ParentLandscape->GetParentHeight();
+			InitialHeights[i] = ParentLandscape->QuantizeHeight(
+				HeightValuesInitial[i] + ParentLandscape->GetParentHeight());
 		}
 
 		Index = ComponentIndex;
@@ -43,52 +67,259 @@ FVector2D URuntimeLandscapeComponent::GetRelativeVertexLocation(int32 VertexInde
 	                 Coordinates.Y * ParentLandscape->GetQuadSideLength());
 }
 
-UHierarchicalInstancedStaticMeshComponent* URuntimeLandscapeComponent::FindOrAddGrassMesh(const FGrassVariety& Variety)
+void URuntimeLandscapeComponent::SetGrassEnabled(bool bEnabled)
 {
-	UHierarchicalInstancedStaticMeshComponent** Mesh = GrassMeshes.FindByPredicate(
-		[Variety](const UHierarchicalInstancedStaticMeshComponent* Current)
+	if (bIsGrassEnabled == bEnabled)
+	{
+		return;
+	}
+
+	bIsGrassEnabled = bEnabled;
+	if (bIsGrassEnabled)
+	{
+		RebuildGrass();
+	}
+	else if (!bIsStale)
+	{
+		ReleaseGrass();
+	}
+	// otherwise the running rebuild releases the grass when it finishes
+}
+
+void URuntimeLandscapeComponent::SetStreamedIn(bool bStreamedIn)
+{
+	if (bIsStreamedIn == bStreamedIn)
+	{
+		return;
+	}
+
+	bIsStreamedIn = bStreamedIn;
+	if (bIsStreamedIn)
+	{
+		Rebuild();
+		return;
+	}
+
+	// the workers of a queued or running rebuild still read the grass, so it is released when the rebuild ends
+	if (!bIsStale)
+	{
+		ReleaseStreamedOutData();
+	}
+}
+
+void URuntimeLandscapeComponent::ReleaseStreamedOutData()
+{
+	// the heights are kept, so navigation and saved edits stay valid
+	ReleaseGrass();
+	ClearAllMeshSections();
+	UpdateMemoryStats();
+	UE_LOG(RuntimeEditableLandscape, Verbose, TEXT("Streamed out Landscape component %s %i"), *GetOwner()->GetName(),
+	       Index);
+}
+
+int32 URuntimeLandscapeComponent::GetGrassInstanceAmount() const
+{
+	return GeneratedGrass.GetInstanceAmount();
+}
+
+float URuntimeLandscapeComponent::GetBuiltHeightRelative(int32 VertexIndex) const
+{
+	return ParentLandscape->DequantizeHeight(HeightValues[VertexIndex]) - ParentLandscape->GetParentHeight();
+}
+
+bool URuntimeLandscapeComponent::CanReprojectGrass() const
+{
+	return bIsGrassEnabled && GrassWeightsVersion == GroundTypeWeightsVersion
+		&& GrassVertexNormals.Num() == ParentLandscape->GetTotalVertexAmountPerComponent()
+		&& HeightValues.Num() == GrassVertexNormals.Num();
+}
+
+void URuntimeLandscapeComponent::ReleaseGrass()
+{
+	// keep the instanced meshes, so they can be reused when the grass is enabled again
+	for (FRuntimeLandscapeGrassMesh& GrassMesh : GrassMeshes)
+	{
+		if (GrassMesh.InstancedMesh)
 		{
-			return Current->GetStaticMesh() == Variety.GrassMesh;
-		});
+			GrassMesh.ClearInstances();
+		}
+	}
+
+	GeneratedGrass.MeshBuffers.Empty();
+	GrassVertexNormals.Empty();
+
+	if (ParentLandscape->IsGrassClustered())
+	{
+		ParentLandscape->UpdateGrassClusters(*this);
+	}
+}
+
+int32 URuntimeLandscapeComponent::FindOrAddGrassMesh(const FGrassVariety& Variety)
+{
+	return FRuntimeLandscapeGrassMesh::FindOrAdd(GrassMeshes, Variety, this);
+}
+
+void URuntimeLandscapeComponent::AddGrassMeshes(const FLandscapeGrassData& GrassData,
+                                                TArray<int32>& OutGrassMeshIndices)
+{
+	OutGrassMeshIndices.SetNumUninitialized(GrassData.MeshBuffers.Num());
+	for (int32 i = 0; i < GrassData.MeshBuffers.Num(); ++i)
+	{
+		const FLandscapeGrassMeshBuffer& MeshBuffer = GrassData.MeshBuffers[i];
+		OutGrassMeshIndices[i] = MeshBuffer.InstanceTransformsRelative.IsEmpty()
+			                         ? INDEX_NONE
+			                         : FindOrAddGrassMesh(*MeshBuffer.GrassVariety);
+	}
+}
+
+void URuntimeLandscapeComponent::UpdateGrass(FRuntimeLandscapeRebuildBuffer& RebuildBuffer)
+{
+	RUNTIME_LANDSCAPE_SCOPE_STAT(UpdateGrass);
+	// grass might have been disabled while the rebuild was running
+	if (!bIsGrassEnabled)
+	{
+		ReleaseGrass();
+		return;
+	}
 
-	if (Mesh)
+	int32 ChangedInstanceAmount = 0;
+	if (!ParentLandscape->IsGrassClustered())
 	{
-		return *Mesh;
+		ChangedInstanceAmount = UpdateGrassMeshes(RebuildBuffer);
 	}
 
-	UHierarchicalInstancedStaticMeshComponent* InstancedStaticMesh = NewObject<
-		UHierarchicalInstancedStaticMeshComponent>(GetOwner());
-	InstancedStaticMesh->SetStaticMesh(Variety.GrassMesh);
-	InstancedStaticMesh->AttachToComponent(this, FAttachmentTransformRules::SnapToTargetIncludingScale);
-	InstancedStaticMesh->RegisterComponent();
-	InstancedStaticMesh->SetCullDistances(Variety.GetStartCullDistance(), Variety.GetEndCullDistance());
-	InstancedStaticMesh->SetCastShadow(Variety.bCastDynamicShadow);
-	InstancedStaticMesh->SetCastContactShadow(Variety.bCastContactShadow);
+	// remember the generated grass, so it can be reprojected on the next rebuild
+	Swap(GeneratedGrass, RebuildBuffer.GrassData);
+	GrassWeightsVersion = RebuildBuffer.GrassWeightsVersion;
+	GrassVertexNormals = RebuildBuffer.Normals;
 
-	GrassMeshes.Add(InstancedStaticMesh);
-	return InstancedStaticMesh;
+	// clusters are composed from the generated grass of all components that share them
+	if (ParentLandscape->IsGrassClustered())
+	{
+		ChangedInstanceAmount = ParentLandscape->UpdateGrassClusters(*this);
+	}
+
+	UE_LOG(RuntimeEditableLandscape, Verbose, TEXT("	Updated %i grass instances of Landscape component %s %i"),
+	       ChangedInstanceAmount, *GetOwner()->GetName(), Index);
+}
+
+int32 URuntimeLandscapeComponent::UpdateGrassMeshes(FRuntimeLandscapeRebuildBuffer& RebuildBuffer)
+{
+	for (const FLandscapeGrassMeshBuffer& MeshBuffer : RebuildBuffer.GrassData.MeshBuffers)
+	{
+		if (MeshBuffer.InstanceTransformsRelative.IsEmpty() == false)
+		{
+			GrassMeshes[FindOrAddGrassMesh(*MeshBuffer.GrassVariety)].ApplyVarietySettings(*MeshBuffer.GrassVariety);
+		}
+	}
+
+	// update all pooled meshes, meshes without instances in this rebuild are cleared but kept for reuse
+	const int32 VertexAmount = RebuildBuffer.VerticesRelative.Num();
+	int32 ChangedInstanceAmount = 0;
+	for (FRuntimeLandscapeGrassMesh& GrassMesh : GrassMeshes)
+	{
+		if (!ensure(GrassMesh.InstancedMesh))
+		{
+			continue;
+		}
+
+		const int32 MeshBufferIndex = RebuildBuffer.GrassData.MeshBuffers.IndexOfByPredicate(
+			[&GrassMesh](const FLandscapeGrassMeshBuffer& Current)
+			{
+				return Current.GrassVariety->GrassMesh == GrassMesh.InstancedMesh->GetStaticMesh();
+			});
+
+		FLandscapeGrassTree* GrassTree = RebuildBuffer.GrassTrees.FindByPredicate(
+			[MeshBufferIndex](const FLandscapeGrassTree& Current)
+			{
+				return Current.MeshBufferIndex == MeshBufferIndex;
+			});
+
+		if (GrassTree)
+		{
+			ChangedInstanceAmount += GrassTree->SortedVertices.Num();
+			GrassMesh.AcceptPrebuiltTree(*GrassTree);
+		}
+		else if (MeshBufferIndex != INDEX_NONE)
+		{
+			const FLandscapeGrassMeshBuffer& MeshBuffer = RebuildBuffer.GrassData.MeshBuffers[MeshBufferIndex];
+			ChangedInstanceAmount += GrassMesh.UpdateInstances(MeshBuffer.InstanceTransformsRelative,
+			                                                   MeshBuffer.InstanceVertices, VertexAmount);
+		}
+		else
+		{
+			ChangedInstanceAmount += GrassMesh.UpdateInstances(TConstArrayView<FTransform>(),
+			                                                   TConstArrayView<int32>(), VertexAmount);
+		}
+	}
+
+	return ChangedInstanceAmount;
 }
 
 void URuntimeLandscapeComponent::Rebuild()
 {
+	if (!bIsStreamedIn)
+	{
+		bOnlyGrassIsStale = false;
+		return;
+	}
+
+	ParentLandscape->GetEditTracker().AttachEdit(Index, PendingEditIds);
+	if (bIsRebuilding)
+	{
+		bIsRebuildRequested = true;
+		bIsOnlyGrassRebuildRequested = false;
+		return;
+	}
+
+	bOnlyGrassIsStale = false;
+	if (bIsStale)
+	{
+		return;
+	}
+
+	bIsStale = true;
+	QueuedCycles = FPlatformTime::Cycles64();
+	ParentLandscape->GetRebuildManager()->QueueRebuild(this);
+}
+
+void URuntimeLandscapeComponent::RebuildGrass()
+{
+	if (!bIsStreamedIn)
+	{
+		return;
+	}
+
+	ParentLandscape->GetEditTracker().AttachEdit(Index, PendingEditIds);
+	if (bIsRebuilding)
+	{
+		bIsOnlyGrassRebuildRequested = !bIsRebuildRequested || bIsOnlyGrassRebuildRequested;
+		bIsRebuildRequested = true;
+		return;
+	}
+
 	if (bIsStale)
 	{
 		return;
 	}
 
 	bIsStale = true;
+	QueuedCycles = FPlatformTime::Cycles64();
+	bOnlyGrassIsStale = true;
 	ParentLandscape->GetRebuildManager()->QueueRebuild(this);
 }
 
 void URuntimeLandscapeComponent::ApplyDataFromLayers(TArray<float>& OutHeightValues, TArray<FColor>& OutVertexColors)
 {
-	check(OutHeightValues.Num() == InitialHeightValues.Num());
+	RUNTIME_LANDSCAPE_SCOPE_STAT(ApplyLayers);
+	check(OutHeightValues.Num() == InitialHeights.Num());
 
 	VerticesInHole.Empty();
-	OutVertexColors.Init(FColor::White, InitialHeightValues.Num());
+	EditedHeights.GetHoles(VerticesInHole);
+	OutVertexColors.Init(FColor::White, InitialHeights.Num());
 	for (const ULandscapeLayerComponent* Layer : AffectingLayers)
 	{
-		for (int32 i = 0; i < InitialHeightValues.Num(); i++)
+		for (int32 i = 0; i < InitialHeights.Num(); i++)
 		{
 			Layer->ApplyLayerData(i, this, OutHeightValues[i],
 			                      OutVertexColors[i]);
@@ -96,79 +327,189 @@ void URuntimeLandscapeComponent::ApplyDataFromLayers(TArray<float>& OutHeightVal
 	}
 }
 
-void URuntimeLandscapeComponent::UpdateNavigation()
+void URuntimeLandscapeComponent::CommitLandscapeLayer(const ULandscapeLayerComponent* Layer)
 {
-	if (ParentLandscape->bUpdateNavigation)
+	EditedHeights.Initialize(ParentLandscape->GetVertexAmountPerComponent());
+
+	// hole layers flag the vertices directly, so the holes of the current build are kept aside
+	TSet<int32> BuildVerticesInHole = MoveTemp(VerticesInHole);
+	VerticesInHole.Reset();
+
+	for (int32 VertexIndex = 0; VertexIndex < InitialHeights.Num(); ++VertexIndex)
+	{
+		const uint16 Height = GetBaseHeight(VertexIndex);
+		float HeightValue = ParentLandscape->DequantizeHeight(Height);
+		// vertex colors are not committed, but layers blend into them like on a rebuild
+		FColor VertexColor = FColor::White;
+		Layer->ApplyLayerData(VertexIndex, this, HeightValue, VertexColor);
+		EditedHeights.SetHeight(VertexIndex, ParentLandscape->QuantizeHeight(HeightValue), InitialHeights);
+	}
+
+	for (const int32 VertexIndex : VerticesInHole)
+	{
+		EditedHeights.SetHole(VertexIndex, true, InitialHeights);
+	}
+
+	VerticesInHole = MoveTemp(BuildVerticesInHole);
+}
+
+bool URuntimeLandscapeComponent::CanCommitLandscapeLayer(const ULandscapeLayerComponent* Layer) const
+{
+	const FBox2D* LayerBounds = AffectingLayerBounds.Find(Layer);
+	if (!ensure(LayerBounds))
+	{
+		return false;
+	}
+
+	for (const ULandscapeLayerComponent* AffectingLayer : AffectingLayers)
 	{
-		if (const UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+		if (AffectingLayer == Layer)
 		{
-			NavSys->UpdateComponentInNavOctree(*this);
+			return true;
+		}
+
+		const FBox2D* AffectingLayerBox = AffectingLayerBounds.Find(AffectingLayer);
+		if (AffectingLayerBox && AffectingLayerBox->Intersect(*LayerBounds))
+		{
+			return false;
 		}
 	}
+
+	return false;
 }
 
-void URuntimeLandscapeComponent::RemoveFoliageAffectedByLayer() const
+uint32 URuntimeLandscapeComponent::CalculateMeshCacheHash(const TArray<float>& BuiltHeightValues) const
 {
-	const AInstancedFoliageActor* Foliage = ParentLandscape->GetFoliageActor();
-	if (!Foliage)
+	uint32 Hash = FCrc::MemCrc32(BuiltHeightValues.GetData(),
+	                             BuiltHeightValues.Num() * static_cast<int32>(sizeof(float)));
+	Hash = HashCombine(Hash, GetTypeHash(Index));
+	Hash = HashCombine(Hash, GetTypeHash(ParentLandscape->GetQuadSideLength()));
+	Hash = HashCombine(Hash, GetTypeHash(ParentLandscape->GetParentHeight()));
+
+	// the grass depends on the world height, the ground type weights and the grass settings
+	Hash = HashCombine(Hash, GetTypeHash(GetComponentLocation().Z));
+	Hash = HashCombine(Hash, GetTypeHash(ParentLandscape->GetGrassSeed()));
+	Hash = HashCombine(Hash, ParentLandscape->GetGrassRules().CalculateHash());
+	for (const FGroundTypeWeightPlane& Plane : GroundTypeWeights.Planes)
 	{
-		return;
+		Hash = HashCombine(Hash, FCrc::MemCrc32(Plane.Weights.GetData(), Plane.Weights.Num()));
 	}
 
-	FBox MyBounds = GetLocalBounds().GetBox();
-	MyBounds = MyBounds.MoveTo(GetComponentLocation() + MyBounds.GetExtent());
-	MyBounds = MyBounds.ExpandBy(FVector(0.0f, 0.0f, 10000.0f));
+	return Hash;
+}
 
-	for (const auto& FoliageInfo : Foliage->GetFoliageInfos())
-	{
-		TArray<int32> Instances;
-		UHierarchicalInstancedStaticMeshComponent* FoliageComp = FoliageInfo.Value->GetComponent();
+FBox URuntimeLandscapeComponent::UpdateBuiltHeights(const FRuntimeLandscapeRebuildBuffer& RebuildBuffer)
+{
+	const int32 VertexAmount = RebuildBuffer.VerticesRelative.Num();
+	const bool bIsFirstBuild = HeightValues.Num() != VertexAmount;
+	const bool bHasHoles = VerticesInHole.IsEmpty() == false || BuiltVerticesInHole.IsEmpty() == false;
+	HeightValues.SetNum(VertexAmount);
 
-		TArray<int32> FoliageToRemove;
-		for (int32 Instance : FoliageComp->GetInstancesOverlappingBox(MyBounds))
+	FBox ChangedBounds(ForceInit);
+	for (int32 VertexIndex = 0; VertexIndex < VertexAmount; ++VertexIndex)
+	{
+		const FVector& Vertex = RebuildBuffer.VerticesRelative[VertexIndex];
+		const uint16 Height = ParentLandscape->QuantizeHeight(Vertex.Z + ParentLandscape->GetParentHeight());
+		if (bIsFirstBuild || HeightValues[VertexIndex] != Height || (bHasHoles && VerticesInHole.Contains(VertexIndex)
+			!= BuiltVerticesInHole.Contains(VertexIndex)))
 		{
-			FTransform InstanceTransform;
-			FoliageComp->GetInstanceTransform(Instance, InstanceTransform, true);
-			FVector2D InstanceLocation = FVector2D(InstanceTransform.GetLocation());
-
-			for (const ULandscapeLayerComponent* Layer : AffectingLayers)
+			// include the previous height, so removed geometry is rebuilt as well
+			ChangedBounds += Vertex;
+			if (!bIsFirstBuild)
 			{
-				if (Layer->IsAffectedByLayer(InstanceLocation))
-				{
-					FoliageToRemove.Add(Instance);
-					break;
-				}
+				ChangedBounds += FVector(Vertex.X, Vertex.Y, GetBuiltHeightRelative(VertexIndex));
 			}
+
+			HeightValues[VertexIndex] = Height;
 		}
+	}
 
-		FoliageComp->RemoveInstances(FoliageToRemove);
+	BuiltVerticesInHole = VerticesInHole;
+	if (!ChangedBounds.IsValid)
+	{
+		return ChangedBounds;
 	}
+
+	// the triangles around the changed vertices change as well
+	const float QuadSideLength = ParentLandscape->GetQuadSideLength();
+	return ChangedBounds.ExpandBy(FVector(QuadSideLength)).TransformBy(GetComponentTransform());
 }
 
-void URuntimeLandscapeComponent::FinishRebuild(const FRuntimeLandscapeRebuildBuffer& RebuildBuffer)
+void URuntimeLandscapeComponent::UpdateNavigation(const FBox& ChangedBounds)
 {
-	// TODO: Reuse stuff instead of recreating everything
-	// clean up old stuff
-	for (UHierarchicalInstancedStaticMeshComponent* GrassMesh : GrassMeshes)
+	RUNTIME_LANDSCAPE_SCOPE_STAT(Navigation);
+	if (ParentLandscape->bUpdateNavigation && ChangedBounds.IsValid)
 	{
-		if (ensure(GrassMesh))
+		if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
 		{
-			GrassMesh->DestroyComponent();
+			// only refresh the geometry, the landscape marks the changed area dirty
+			NavSys->UpdateNavOctreeElement(this, this, FNavigationOctreeController::OctreeUpdate_Refresh);
+			ParentLandscape->AddNavigationDirtyArea(ChangedBounds);
 		}
 	}
+}
 
-	GrassMeshes.Empty();
+void URuntimeLandscapeComponent::UpdateFoliageMask()
+{
+	RUNTIME_LANDSCAPE_SCOPE_STAT(Foliage);
+	const AInstancedFoliageActor* Foliage = ParentLandscape->GetFoliageActor();
+	if (!Foliage)
+	{
+		return;
+	}
+
+	if (!FoliageMask.IsInitialized())
+	{
+		const FBox2D ComponentBounds = ParentLandscape->GetComponentBounds(Index).ShiftBy(
+			FVector2D(ParentLandscape->GetOriginLocation()));
+		FoliageMask.Initialize(*Foliage, ComponentBounds);
+		FoliageDirtyArea = ComponentBounds;
+	}
 
-	for (const FLandscapeAdditionalData& AdditionalData : RebuildBuffer.AdditionalData)
+	FoliageMask.Update(FoliageDirtyArea, [this](const FVector2D& Location)
 	{
-		for (const auto& GrassData : AdditionalData.GrassData)
+		for (const ULandscapeLayerComponent* Layer : AffectingLayers)
 		{
-			if (GrassData.Value.InstanceTransformsRelative.IsEmpty() == false)
+			if (Layer && Layer->IsAffectedByLayer(Location))
 			{
-				UHierarchicalInstancedStaticMeshComponent* GrassMesh = FindOrAddGrassMesh(GrassData.Value.GrassVariety);
-				GrassMesh->AddInstances(GrassData.Value.InstanceTransformsRelative, false);
+				return true;
 			}
 		}
+
+		return false;
+	});
+
+	FoliageDirtyArea = FBox2D(ForceInit);
+}
+
+void URuntimeLandscapeComponent::FinishRebuild(FRuntimeLandscapeRebuildBuffer& RebuildBuffer)
+{
+	// the component was streamed out while it was rebuilding
+	if (!bIsStreamedIn)
+	{
+		bOnlyGrassIsStale = false;
+		bIsStale = false;
+		ReleaseStreamedOutData();
+		return;
+	}
+
+	// only editor builds are stored, since they are saved with the level
+	if (ParentLandscape->bUseMeshCache && !RebuildBuffer.bIsRestoredFromCache && !GetWorld()->IsGameWorld())
+	{
+		RUNTIME_LANDSCAPE_SCOPE_STAT(MeshCacheStore);
+		MeshCache.Store(RebuildBuffer, *RebuildBuffer.GrassRules, bIsGrassEnabled);
+	}
+
+	{
+		RUNTIME_LANDSCAPE_TRACE_STAGE(UpdateGrass, Index, RebuildBuffer.EditIds);
+		UpdateGrass(RebuildBuffer);
+	}
+
+	if (bOnlyGrassIsStale)
+	{
+		bOnlyGrassIsStale = false;
+		bIsStale = false;
+		return;
 	}
 
 #if WITH_EDITORONLY_DATA
@@ -230,25 +571,196 @@ void URuntimeLandscapeComponent::FinishRebuild(const FRuntimeLandscapeRebuildBuf
 		Triangles = ParentLandscape->GetRebuildManager()->GenerateTriangleArray(&VerticesInHole);
 	}
 
-	CreateMeshSection(0, RebuildBuffer.VerticesRelative, Triangles, RebuildBuffer.Normals, RebuildBuffer.UV0Coords,
-	                  RebuildBuffer.UV1Coords, RebuildBuffer.UV0Coords, RebuildBuffer.UV0Coords, VertexColors,
-	                  RebuildBuffer.Tangents, ParentLandscape->bUpdateCollision);
+	{
+		// the collision is cooked when the section is created
+		RUNTIME_LANDSCAPE_SCOPE_STAT(CommitMesh);
+		RUNTIME_LANDSCAPE_TRACE_STAGE(CommitMesh, Index, RebuildBuffer.EditIds);
+		CreateMeshSection(0, RebuildBuffer.VerticesRelative, Triangles, RebuildBuffer.Normals,
+		                  RebuildBuffer.UV0Coords, RebuildBuffer.UV1Coords, RebuildBuffer.UV0Coords,
+		                  RebuildBuffer.UV0Coords, VertexColors, RebuildBuffer.Tangents,
+		                  ParentLandscape->bUpdateCollision);
+	}
+
+	{
+		RUNTIME_LANDSCAPE_TRACE_STAGE(Foliage, Index, RebuildBuffer.EditIds);
+		UpdateFoliageMask();
+	}
 
-	RemoveFoliageAffectedByLayer();
-	UpdateNavigation();
+	{
+		RUNTIME_LANDSCAPE_TRACE_STAGE(Navigation, Index, RebuildBuffer.EditIds);
+		UpdateNavigation(UpdateBuiltHeights(RebuildBuffer));
+	}
 
 	UE_LOG(RuntimeEditableLandscape, Display, TEXT("	Finished rebuilding Landscape component %s %i..."),
 	       *GetOwner()->GetName(), Index);
 	bIsStale = false;
 }
 
+bool URuntimeLandscapeComponent::DoCustomNavigableGeometryExport(FNavigableGeometryExport& GeomExport) const
+{
+	RUNTIME_LANDSCAPE_SCOPE_STAT(NavigationExport);
+	// use the default export until the component was built
+	if (!ParentLandscape || HeightValues.Num() != ParentLandscape->GetTotalVertexAmountPerComponent())
+	{
+		return true;
+	}
+
+	const FIntVector2& VertexAmount = ParentLandscape->GetVertexAmountPerComponent();
+	TBitArray<> HoleVertices(false, HeightValues.Num());
+	for (const int32 VertexIndex : BuiltVerticesInHole)
+	{
+		HoleVertices[VertexIndex] = true;
+	}
+
+	TArray<FVector> Vertices;
+	TArray<int32> Indices;
+	AppendNavigationArea(FIntPoint::ZeroValue, FIntPoint(VertexAmount.X - 1, VertexAmount.Y - 1), HoleVertices,
+	                     Vertices, Indices);
+
+	if (Indices.IsEmpty() == false)
+	{
+		GeomExport.ExportCustomMesh(Vertices.GetData(), Vertices.Num(), Indices.GetData(), Indices.Num(),
+		                            GetComponentTransform());
+	}
+
+	return false;
+}
+
+void URuntimeLandscapeComponent::AppendNavigationArea(const FIntPoint& Min, const FIntPoint& Max,
+                                                      const TBitArray<>& HoleVertices, TArray<FVector>& OutVertices,
+                                                      TArray<int32>& OutIndices) const
+{
+	const int32 RowLength = ParentLandscape->GetVertexAmountPerComponent().X;
+	auto GetVertexIndex = [RowLength](int32 X, int32 Y)
+	{
+		return X + Y * RowLength;
+	};
+
+	const float Height00 = GetBuiltHeightRelative(GetVertexIndex(Min.X, Min.Y));
+	const float Height10 = GetBuiltHeightRelative(GetVertexIndex(Max.X, Min.Y));
+	const float Height01 = GetBuiltHeightRelative(GetVertexIndex(Min.X, Max.Y));
+	const float Height11 = GetBuiltHeightRelative(GetVertexIndex(Max.X, Max.Y));
+
+	// check if the two triangles of the area approximate all heights inside it
+	bool bIsLeaf = true;
+	const bool bIsSingleQuad = Max.X - Min.X == 1 && Max.Y - Min.Y == 1;
+	if (!bIsSingleQuad)
+	{
+		const float Tolerance = ParentLandscape->NavigationGeometryTolerance;
+		const float SizeX = Max.X - Min.X;
+		const float SizeY = Max.Y - Min.Y;
+		for (int32 Y = Min.Y; Y <= Max.Y && bIsLeaf; ++Y)
+		{
+			for (int32 X = Min.X; X <= Max.X; ++X)
+			{
+				const int32 VertexIndex = GetVertexIndex(X, Y);
+				const float U = (X - Min.X) / SizeX;
+				const float V = (Y - Min.Y) / SizeY;
+				const float ApproximatedHeight = U + V <= 1.0f
+					                                 ? Height00 + U * (Height10 - Height00) + V * (Height01 - Height00)
+					                                 : Height11 + (1.0f - U) * (Height01 - Height11) + (1.0f - V) *
+					                                 (Height10 - Height11);
+				if (HoleVertices[VertexIndex] || FMath::Abs(ApproximatedHeight - GetBuiltHeightRelative(VertexIndex)) >
+					Tolerance)
+				{
+					bIsLeaf = false;
+					break;
+				}
+			}
+		}
+	}
+
+	if (!bIsLeaf)
+	{
+		// split along the longer side, so non square components are supported
+		const FIntPoint Center = (Min + Max) / 2;
+		if (Max.X - Min.X > 1 && Max.Y - Min.Y > 1)
+		{
+			AppendNavigationArea(Min, Center, HoleVertices, OutVertices, OutIndices);
+			AppendNavigationArea(FIntPoint(Center.X, Min.Y), FIntPoint(Max.X, Center.Y), HoleVertices, OutVertices,
+			                     OutIndices);
+			AppendNavigationArea(FIntPoint(Min.X, Center.Y), FIntPoint(Center.X, Max.Y), HoleVertices, OutVertices,
+			                     OutIndices);
+			AppendNavigationArea(Center, Max, HoleVertices, OutVertices, OutIndices);
+		}
+		else if (Max.X - Min.X > 1)
+		{
+			AppendNavigationArea(Min, FIntPoint(Center.X, Max.Y), HoleVertices, OutVertices, OutIndices);
+			AppendNavigationArea(FIntPoint(Center.X, Min.Y), Max, HoleVertices, OutVertices, OutIndices);
+		}
+		else
+		{
+			AppendNavigationArea(Min, FIntPoint(Max.X, Center.Y), HoleVertices, OutVertices, OutIndices);
+			AppendNavigationArea(FIntPoint(Min.X, Center.Y), Max, HoleVertices, OutVertices, OutIndices);
+		}
+
+		return;
+	}
+
+	// quads with a vertex in a hole are not generated, same as in the render mesh
+	if (bIsSingleQuad && (HoleVertices[GetVertexIndex(Min.X, Min.Y)] || HoleVertices[GetVertexIndex(Max.X, Min.Y)]
+		|| HoleVertices[GetVertexIndex(Min.X, Max.Y)] || HoleVertices[GetVertexIndex(Max.X, Max.Y)]))
+	{
+		return;
+	}
+
+	const float QuadSideLength = ParentLandscape->GetQuadSideLength();
+	const int32 FirstIndex = OutVertices.Num();
+	OutVertices.Add(FVector(Min.X * QuadSideLength, Min.Y * QuadSideLength, Height00));
+	OutVertices.Add(FVector(Min.X * QuadSideLength, Max.Y * QuadSideLength, Height01));
+	OutVertices.Add(FVector(Max.X * QuadSideLength, Min.Y * QuadSideLength, Height10));
+	OutVertices.Add(FVector(Max.X * QuadSideLength, Max.Y * QuadSideLength, Height11));
+
+	// same winding as the render mesh
+	OutIndices.Append({FirstIndex, FirstIndex + 1, FirstIndex + 2, FirstIndex + 2, FirstIndex + 1, FirstIndex + 3});
+}
+
+void URuntimeLandscapeComponent::UpdateMemoryStats()
+{
+	const int64 HeightMemory = InitialHeights.GetAllocatedSize() + HeightValues.GetAllocatedSize() + EditedHeights.
+		GetAllocatedSize();
+	const int64 WeightMemory = GroundTypeWeights.GetAllocatedSize();
+	const int64 GrassMemory = GeneratedGrass.GetAllocatedSize() + GrassVertexNormals.GetAllocatedSize();
+
+	FRuntimeEditableLandscapeModule::TrackMemory(ERuntimeLandscapeMemory::Heights, HeightMemory - TrackedHeightMemory);
+	FRuntimeEditableLandscapeModule::TrackMemory(ERuntimeLandscapeMemory::GroundTypeWeights,
+	                                             WeightMemory - TrackedWeightMemory);
+	FRuntimeEditableLandscapeModule::TrackMemory(ERuntimeLandscapeMemory::Grass, GrassMemory - TrackedGrassMemory);
+	TrackedHeightMemory = HeightMemory;
+	TrackedWeightMemory = WeightMemory;
+	TrackedGrassMemory = GrassMemory;
+}
+
+void URuntimeLandscapeComponent::ReleaseMemoryStats()
+{
+	FRuntimeEditableLandscapeModule::TrackMemory(ERuntimeLandscapeMemory::Heights, -TrackedHeightMemory);
+	FRuntimeEditableLandscapeModule::TrackMemory(ERuntimeLandscapeMemory::GroundTypeWeights, -TrackedWeightMemory);
+	FRuntimeEditableLandscapeModule::TrackMemory(ERuntimeLandscapeMemory::Grass, -TrackedGrassMemory);
+	TrackedHeightMemory = 0;
+	TrackedWeightMemory = 0;
+	TrackedGrassMemory = 0;
+}
+
+void URuntimeLandscapeComponent::OnRegister()
+{
+	Super::OnRegister();
+	UpdateMemoryStats();
+}
+
+void URuntimeLandscapeComponent::OnUnregister()
+{
+	ReleaseMemoryStats();
+	Super::OnUnregister();
+}
+
 void URuntimeLandscapeComponent::DestroyComponent(bool bPromoteChildren)
 {
-	for (UHierarchicalInstancedStaticMeshComponent* GrassMesh : GrassMeshes)
+	FoliageMask.RestoreAll();
+	for (const FRuntimeLandscapeGrassMesh& GrassMesh : GrassMeshes)
 	{
-		if (GrassMesh)
+		if (GrassMesh.InstancedMesh)
 		{
-			GrassMesh->DestroyComponent();
+			GrassMesh.InstancedMesh->DestroyComponent();
 		}
 	}
 
@@ -0,0 +1,603 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RuntimeLandscapeDeltaSave.h"
+
+#include "RuntimeEditableLandscape.h"
+#include "RuntimeLandscape.h"
+#include "RuntimeLandscapeComponent.h"
+#include "Async/ParallelFor.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+/** Identifies landscape edit data */
+static constexpr uint32 DeltaSaveMagic = 0x534C5452;
+
+void FRuntimeLandscapeDeltaSave::Write(const ARuntimeLandscape& Landscape, TArray<uint8>& OutData)
+{
+	OutData.Reset();
+	FMemoryWriter Writer(OutData);
+
+	uint32 Magic = DeltaSaveMagic;
+	int32 Version = CurrentVersion;
+	int32 SavedTileSize = TileSize;
+	int32 VertexAmountX = Landscape.VertexAmountPerComponent.X;
+	int32 VertexAmountY = Landscape.VertexAmountPerComponent.Y;
+	int32 ComponentAmount = Landscape.LandscapeComponents.Num();
+	float HeightScale = Landscape.HeightScale;
+	Writer << Magic;
+	Writer << Version;
+	Writer << SavedTileSize;
+	Writer << VertexAmountX;
+	Writer << VertexAmountY;
+	Writer << ComponentAmount;
+	Writer << HeightScale;
+
+	// weights are referenced by ground type, so saves survive changes of the ground type setup
+	TArray<FString> GroundTypePaths;
+	for (int32 Plane = 0; Plane < Landscape.GetGroundTypeAmount(); ++Plane)
+	{
+		const ULandscapeGroundTypeData* GroundType = Landscape.GetGroundTypeForPlane(Plane);
+		GroundTypePaths.Add(GroundType ? GroundType->GetPathName() : FString());
+	}
+
+	Writer << GroundTypePaths;
+
+	// every component is written as separate block, so the components can be decoded in parallel
+	TArray<TArray<uint8>> Blocks;
+	Blocks.SetNum(ComponentAmount);
+	ParallelFor(ComponentAmount, [&Landscape, &Blocks](int32 ComponentIndex)
+	{
+		const URuntimeLandscapeComponent* Component = Landscape.LandscapeComponents[ComponentIndex];
+		if (!Component)
+		{
+			return;
+		}
+
+		FMemoryWriter BlockWriter(Blocks[ComponentIndex]);
+		if (!WriteComponent(*Component, BlockWriter))
+		{
+			Blocks[ComponentIndex].Empty();
+		}
+	});
+
+	int32 BlockAmount = Blocks.FilterByPredicate([](const TArray<uint8>& Block) { return Block.Num() > 0; }).Num();
+	Writer << BlockAmount;
+	for (int32 ComponentIndex = 0; ComponentIndex < ComponentAmount; ++ComponentIndex)
+	{
+		if (Blocks[ComponentIndex].Num() > 0)
+		{
+			int32 SavedComponentIndex = ComponentIndex;
+			Writer << SavedComponentIndex;
+			Writer << Blocks[ComponentIndex];
+		}
+	}
+
+	UE_LOG(RuntimeEditableLandscape, Display, TEXT("Saved edits of %i components of %s (%i bytes)"), BlockAmount,
+	       *Landscape.GetName(), OutData.Num());
+}
+
+bool FRuntimeLandscapeDeltaSave::Apply(ARuntimeLandscape& Landscape, const TArray<uint8>& Data)
+{
+	FMemoryReader Reader(Data);
+
+	uint32 Magic = 0;
+	int32 Version = INDEX_NONE;
+	int32 SavedTileSize = 0;
+	int32 VertexAmountX = 0;
+	int32 VertexAmountY = 0;
+	int32 ComponentAmount = 0;
+	float HeightScale = 0.0f;
+	Reader << Magic;
+	Reader << Version;
+	Reader << SavedTileSize;
+	Reader << VertexAmountX;
+	Reader << VertexAmountY;
+	Reader << ComponentAmount;
+	Reader << HeightScale;
+
+	if (Reader.IsError() || Magic != DeltaSaveMagic || Version != CurrentVersion || SavedTileSize != TileSize)
+	{
+		UE_LOG(RuntimeEditableLandscape, Warning,
+		       TEXT("Edits of %s could not be loaded, the data is invalid or of an unsupported version!"),
+		       *Landscape.GetName());
+		return false;
+	}
+
+	if (VertexAmountX != Landscape.VertexAmountPerComponent.X || VertexAmountY != Landscape.VertexAmountPerComponent.Y
+		|| ComponentAmount != Landscape.LandscapeComponents.Num() || HeightScale <= 0.0f)
+	{
+		UE_LOG(RuntimeEditableLandscape, Warning,
+		       TEXT("Edits of %s could not be loaded, they were saved for a different landscape layout!"),
+		       *Landscape.GetName());
+		return false;
+	}
+
+	TArray<FString> GroundTypePaths;
+	Reader << GroundTypePaths;
+	TArray<int32> PlaneMapping;
+	PlaneMapping.Init(INDEX_NONE, GroundTypePaths.Num());
+	for (int32 SavedPlane = 0; SavedPlane < GroundTypePaths.Num(); ++SavedPlane)
+	{
+		for (int32 Plane = 0; Plane < Landscape.GetGroundTypeAmount(); ++Plane)
+		{
+			const ULandscapeGroundTypeData* GroundType = Landscape.GetGroundTypeForPlane(Plane);
+			if (GroundType && GroundType->GetPathName() == GroundTypePaths[SavedPlane])
+			{
+				PlaneMapping[SavedPlane] = Plane;
+				break;
+			}
+		}
+
+		if (PlaneMapping[SavedPlane] == INDEX_NONE && GroundTypePaths[SavedPlane].IsEmpty() == false)
+		{
+			UE_LOG(RuntimeEditableLandscape, Warning,
+			       TEXT("Ground type %s is not used by %s anymore, its saved weights are discarded"),
+			       *GroundTypePaths[SavedPlane], *Landscape.GetName());
+		}
+	}
+
+	int32 BlockAmount = 0;
+	Reader << BlockAmount;
+	if (Reader.IsError() || BlockAmount < 0 || BlockAmount > ComponentAmount)
+	{
+		UE_LOG(RuntimeEditableLandscape, Warning, TEXT("Edits of %s could not be loaded, the data is invalid!"),
+		       *Landscape.GetName());
+		return false;
+	}
+
+	TArray<int32> BlockComponents;
+	TArray<TArray<uint8>> Blocks;
+	BlockComponents.SetNum(BlockAmount);
+	Blocks.SetNum(BlockAmount);
+	for (int32 Block = 0; Block < BlockAmount; ++Block)
+	{
+		Reader << BlockComponents[Block];
+		Reader << Blocks[Block];
+		if (Reader.IsError() || !Landscape.LandscapeComponents.IsValidIndex(BlockComponents[Block])
+			|| !Landscape.LandscapeComponents[BlockComponents[Block]]
+			|| BlockComponents.Find(BlockComponents[Block]) != Block)
+		{
+			UE_LOG(RuntimeEditableLandscape, Warning, TEXT("Edits of %s could not be loaded, the data is invalid!"),
+			       *Landscape.GetName());
+			return false;
+		}
+	}
+
+	// previously restored or committed edits are replaced, the saved heights contain them
+	TArray<bool> ComponentsToRebuild;
+	ComponentsToRebuild.Init(false, ComponentAmount);
+	for (int32 ComponentIndex = 0; ComponentIndex < ComponentAmount; ++ComponentIndex)
+	{
+		URuntimeLandscapeComponent* Component = Landscape.LandscapeComponents[ComponentIndex];
+		if (Component && Component->EditedHeights.IsEmpty() == false)
+		{
+			Component->EditedHeights.Reset();
+			ComponentsToRebuild[ComponentIndex] = true;
+		}
+	}
+
+	// the blocks are only decoded concurrently, the components are changed on the game thread afterwards
+	TArray<FComponentEdits> BlockEdits;
+	TArray<bool> IsBlockValid;
+	BlockEdits.SetNum(BlockAmount);
+	IsBlockValid.Init(false, BlockAmount);
+	ParallelFor(BlockAmount, [&](int32 Block)
+	{
+		FMemoryReader BlockReader(Blocks[Block]);
+		IsBlockValid[Block] = ReadComponent(*Landscape.LandscapeComponents[BlockComponents[Block]], BlockReader,
+		                                    PlaneMapping, HeightScale, BlockEdits[Block]);
+	});
+
+	bool bIsValid = true;
+	bool bHasWeights = false;
+	for (int32 Block = 0; Block < BlockAmount; ++Block)
+	{
+		URuntimeLandscapeComponent* Component = Landscape.LandscapeComponents[BlockComponents[Block]];
+		ComponentsToRebuild[BlockComponents[Block]] = true;
+		if (!IsBlockValid[Block])
+		{
+			UE_LOG(RuntimeEditableLandscape, Warning, TEXT("Saved edits of component %i of %s could not be read!"),
+			       BlockComponents[Block], *Landscape.GetName());
+			bIsValid = false;
+			continue;
+		}
+
+		FComponentEdits& Edits = BlockEdits[Block];
+		Component->EditedHeights = MoveTemp(Edits.Heights);
+		if (Edits.bHasWeights)
+		{
+			Component->GroundTypeWeights = MoveTemp(Edits.Weights);
+			Component->EditedWeightTiles = MoveTemp(Edits.EditedWeightTiles);
+			Component->MarkGroundTypeWeightsChanged();
+			bHasWeights = true;
+		}
+	}
+
+	// queued components read the edits when their rebuild starts, rebuilding components are queued again
+	Landscape.RebuildManager->BeginBulkBuild();
+	for (int32 ComponentIndex = 0; ComponentIndex < ComponentAmount; ++ComponentIndex)
+	{
+		if (ComponentsToRebuild[ComponentIndex])
+		{
+			Landscape.LandscapeComponents[ComponentIndex]->Rebuild();
+		}
+	}
+
+	Landscape.RebuildManager->EndBulkBuild();
+
+	if (bHasWeights)
+	{
+		const FIntRect WeightMapArea(FIntPoint::ZeroValue, Landscape.GetWeightMapSize());
+		for (int32 LayerSetIndex = 0; LayerSetIndex < Landscape.GroundLayerSets.Num(); ++LayerSetIndex)
+		{
+			Landscape.UpdateRenderTargetFromWeights(LayerSetIndex, WeightMapArea);
+		}
+	}
+
+	UE_LOG(RuntimeEditableLandscape, Display, TEXT("Loaded edits of %i components of %s"), BlockAmount,
+	       *Landscape.GetName());
+	return bIsValid;
+}
+
+void FRuntimeLandscapeDeltaSave::MarkWeightsEdited(URuntimeLandscapeComponent& Component, const FIntRect& LocalArea)
+{
+	const FIntPoint TileAmount = GetTileAmount(*Component.ParentLandscape);
+	if (Component.EditedWeightTiles.Num() != TileAmount.X * TileAmount.Y)
+	{
+		Component.EditedWeightTiles.Init(false, TileAmount.X * TileAmount.Y);
+	}
+
+	const FIntPoint FirstTile = LocalArea.Min / TileSize;
+	const FIntPoint LastTile = (LocalArea.Max - FIntPoint(1, 1)) / TileSize;
+	for (int32 Y = FirstTile.Y; Y <= LastTile.Y; ++Y)
+	{
+		for (int32 X = FirstTile.X; X <= LastTile.X; ++X)
+		{
+			Component.EditedWeightTiles[X + Y * TileAmount.X] = true;
+		}
+	}
+}
+
+FIntPoint FRuntimeLandscapeDeltaSave::GetTileAmount(const ARuntimeLandscape& Landscape)
+{
+	const FIntVector2& VertexAmount = Landscape.GetVertexAmountPerComponent();
+	return FIntPoint::DivideAndRoundUp(FIntPoint(VertexAmount.X, VertexAmount.Y), TileSize);
+}
+
+FIntRect FRuntimeLandscapeDeltaSave::GetTileArea(const ARuntimeLandscape& Landscape, int32 TileIndex)
+{
+	const FIntVector2& VertexAmount = Landscape.GetVertexAmountPerComponent();
+	const int32 TileAmountX = GetTileAmount(Landscape).X;
+	const FIntPoint Min(TileIndex % TileAmountX * TileSize, TileIndex / TileAmountX * TileSize);
+	return FIntRect(Min, FIntPoint::ComponentMin(Min + FIntPoint(TileSize), FIntPoint(VertexAmount.X, VertexAmount.Y)));
+}
+
+bool FRuntimeLandscapeDeltaSave::WriteComponent(const URuntimeLandscapeComponent& Component, FArchive& Ar)
+{
+	const ARuntimeLandscape& Landscape = *Component.ParentLandscape;
+	const int32 VertexAmount = Landscape.GetTotalVertexAmountPerComponent();
+	const int32 RowLength = Landscape.GetVertexAmountPerComponent().X;
+	const FIntPoint TileAmount = GetTileAmount(Landscape);
+	const int32 TotalTileAmount = TileAmount.X * TileAmount.Y;
+
+	if (Component.InitialHeights.Num() != VertexAmount)
+	{
+		return false;
+	}
+
+	TArray<int32> HeightTiles;
+	TArray<int32> HoleTiles;
+	TArray<int32> WeightTiles;
+	for (int32 Tile = 0; Tile < TotalTileAmount; ++Tile)
+	{
+		const FIntRect Area = GetTileArea(Landscape, Tile);
+		bool bHasHeightDelta = false;
+		bool bHasHole = false;
+		for (int32 Y = Area.Min.Y; Y < Area.Max.Y; ++Y)
+		{
+			for (int32 X = Area.Min.X; X < Area.Max.X; ++X)
+			{
+				const int32 VertexIndex = X + Y * RowLength;
+				bHasHeightDelta |= Component.GetBaseHeight(VertexIndex) != Component.InitialHeights[VertexIndex];
+				bHasHole |= Component.EditedHeights.IsHole(VertexIndex);
+			}
+		}
+
+		if (bHasHeightDelta)
+		{
+			HeightTiles.Add(Tile);
+		}
+
+		if (bHasHole)
+		{
+			HoleTiles.Add(Tile);
+		}
+
+		if (Component.EditedWeightTiles.IsValidIndex(Tile) && Component.EditedWeightTiles[Tile])
+		{
+			WeightTiles.Add(Tile);
+		}
+	}
+
+	if (HeightTiles.IsEmpty() && HoleTiles.IsEmpty() && WeightTiles.IsEmpty())
+	{
+		return false;
+	}
+
+	// the committed heights are stored as zig-zag encoded difference to the initial height,
+	// so small changes take a single byte
+	int32 HeightTileAmount = HeightTiles.Num();
+	Ar << HeightTileAmount;
+	for (const int32 Tile : HeightTiles)
+	{
+		uint32 PackedTile = Tile;
+		Ar.SerializeIntPacked(PackedTile);
+
+		const FIntRect Area = GetTileArea(Landscape, Tile);
+		for (int32 Y = Area.Min.Y; Y < Area.Max.Y; ++Y)
+		{
+			for (int32 X = Area.Min.X; X < Area.Max.X; ++X)
+			{
+				const int32 VertexIndex = X + Y * RowLength;
+				const int32 Delta = static_cast<int32>(Component.GetBaseHeight(VertexIndex)) - Component.InitialHeights[
+					VertexIndex];
+				uint32 EncodedDelta = (static_cast<uint32>(Delta) << 1) ^ static_cast<uint32>(Delta >> 31);
+				Ar.SerializeIntPacked(EncodedDelta);
+			}
+		}
+	}
+
+	int32 HoleTileAmount = HoleTiles.Num();
+	Ar << HoleTileAmount;
+	for (const int32 Tile : HoleTiles)
+	{
+		uint32 PackedTile = Tile;
+		Ar.SerializeIntPacked(PackedTile);
+
+		const FIntRect Area = GetTileArea(Landscape, Tile);
+		TBitArray<> HoleVertices;
+		for (int32 Y = Area.Min.Y; Y < Area.Max.Y; ++Y)
+		{
+			for (int32 X = Area.Min.X; X < Area.Max.X; ++X)
+			{
+				HoleVertices.Add(Component.EditedHeights.IsHole(X + Y * RowLength));
+			}
+		}
+
+		Ar << HoleVertices;
+	}
+
+	// painted tiles are stored completely, since the baked weights are not kept
+	int32 WeightTileAmount = WeightTiles.Num();
+	Ar << WeightTileAmount;
+	TArray<uint8> TileWeights;
+	for (const int32 Tile : WeightTiles)
+	{
+		uint32 PackedTile = Tile;
+		Ar.SerializeIntPacked(PackedTile);
+
+		const FIntRect Area = GetTileArea(Landscape, Tile);
+		const FGroundTypeWeightTile& Weights = Component.GroundTypeWeights;
+		TArray<int32, TInlineAllocator<8>> TilePlanes;
+		for (int32 Plane = 0; Plane < Weights.Planes.Num(); ++Plane)
+		{
+			if (!Weights.IsPlaneAllocated(Plane))
+			{
+				continue;
+			}
+
+			bool bHasWeight = false;
+			for (int32 Y = Area.Min.Y; Y < Area.Max.Y && !bHasWeight; ++Y)
+			{
+				for (int32 X = Area.Min.X; X < Area.Max.X && !bHasWeight; ++X)
+				{
+					bHasWeight = Weights.GetWeight(Plane, X + Y * RowLength) > 0;
+				}
+			}
+
+			if (bHasWeight)
+			{
+				TilePlanes.Add(Plane);
+			}
+		}
+
+		// planes that are not written have no weight inside the tile
+		uint8 PlaneAmount = TilePlanes.Num();
+		Ar << PlaneAmount;
+		for (const int32 Plane : TilePlanes)
+		{
+			uint32 PackedPlane = Plane;
+			Ar.SerializeIntPacked(PackedPlane);
+
+			TileWeights.Reset();
+			for (int32 Y = Area.Min.Y; Y < Area.Max.Y; ++Y)
+			{
+				TileWeights.Append(&Weights.Planes[Plane].Weights[Area.Min.X + Y * RowLength], Area.Width());
+			}
+
+			Ar.Serialize(TileWeights.GetData(), TileWeights.Num());
+		}
+	}
+
+	return !Ar.IsError();
+}
+
+bool FRuntimeLandscapeDeltaSave::ReadComponent(const URuntimeLandscapeComponent& Component, FArchive& Ar,
+                                               const TArray<int32>& PlaneMapping, float HeightScale,
+                                               FComponentEdits& OutEdits)
+{
+	const ARuntimeLandscape& Landscape = *Component.ParentLandscape;
+	const int32 VertexAmount = Landscape.GetTotalVertexAmountPerComponent();
+	const int32 RowLength = Landscape.GetVertexAmountPerComponent().X;
+	const FIntPoint TileAmount = GetTileAmount(Landscape);
+	const int32 TotalTileAmount = TileAmount.X * TileAmount.Y;
+	OutEdits.bHasWeights = false;
+
+	if (Component.InitialHeights.Num() != VertexAmount)
+	{
+		return false;
+	}
+
+	int32 HeightTileAmount = 0;
+	Ar << HeightTileAmount;
+	if (Ar.IsError() || HeightTileAmount < 0 || HeightTileAmount > TotalTileAmount)
+	{
+		return false;
+	}
+
+	// the deltas are converted if the landscape was baked with a different height scale since saving
+	const float DeltaScale = HeightScale / Landscape.HeightScale;
+	FRuntimeLandscapeHeightTiles& Heights = OutEdits.Heights;
+	Heights.Initialize(Landscape.GetVertexAmountPerComponent());
+
+	for (int32 i = 0; i < HeightTileAmount; ++i)
+	{
+		uint32 Tile = 0;
+		Ar.SerializeIntPacked(Tile);
+		if (Ar.IsError() || Tile >= static_cast<uint32>(TotalTileAmount))
+		{
+			return false;
+		}
+
+		const FIntRect Area = GetTileArea(Landscape, Tile);
+		for (int32 Y = Area.Min.Y; Y < Area.Max.Y; ++Y)
+		{
+			for (int32 X = Area.Min.X; X < Area.Max.X; ++X)
+			{
+				uint32 EncodedDelta = 0;
+				Ar.SerializeIntPacked(EncodedDelta);
+				int32 Delta = static_cast<int32>(EncodedDelta >> 1) ^ -static_cast<int32>(EncodedDelta & 1);
+				if (DeltaScale != 1.0f)
+				{
+					Delta = FMath::RoundToInt(Delta * DeltaScale);
+				}
+
+				const int32 VertexIndex = X + Y * RowLength;
+				Heights.SetHeight(VertexIndex,
+				                  FMath::Clamp(Component.InitialHeights[VertexIndex] + Delta, 0, MAX_uint16),
+				                  Component.InitialHeights);
+			}
+		}
+	}
+
+	int32 HoleTileAmount = 0;
+	Ar << HoleTileAmount;
+	if (Ar.IsError() || HoleTileAmount < 0 || HoleTileAmount > TotalTileAmount)
+	{
+		return false;
+	}
+
+	for (int32 i = 0; i < HoleTileAmount; ++i)
+	{
+		uint32 Tile = 0;
+		TBitArray<> HoleVertices;
+		Ar.SerializeIntPacked(Tile);
+		Ar << HoleVertices;
+		if (Ar.IsError() || Tile >= static_cast<uint32>(TotalTileAmount))
+		{
+			return false;
+		}
+
+		const FIntRect Area = GetTileArea(Landscape, Tile);
+		if (HoleVertices.Num() != Area.Area())
+		{
+			return false;
+		}
+
+		int32 BitIndex = 0;
+		for (int32 Y = Area.Min.Y; Y < Area.Max.Y; ++Y)
+		{
+			for (int32 X = Area.Min.X; X < Area.Max.X; ++X)
+			{
+				if (HoleVertices[BitIndex++])
+				{
+					Heights.SetHole(X + Y * RowLength, true, Component.InitialHeights);
+				}
+			}
+		}
+	}
+
+	int32 WeightTileAmount = 0;
+	Ar << WeightTileAmount;
+	if (Ar.IsError() || WeightTileAmount < 0 || WeightTileAmount > TotalTileAmount)
+	{
+		return false;
+	}
+
+	// the saved tiles replace the tiles of a copy of the current weights
+	FGroundTypeWeightTile& Weights = OutEdits.Weights;
+	if (WeightTileAmount > 0)
+	{
+		Weights = Component.GroundTypeWeights;
+		OutEdits.EditedWeightTiles = Component.EditedWeightTiles;
+		if (OutEdits.EditedWeightTiles.Num() != TotalTileAmount)
+		{
+			OutEdits.EditedWeightTiles.Init(false, TotalTileAmount);
+		}
+	}
+
+	TArray<uint8> TileWeights;
+	for (int32 i = 0; i < WeightTileAmount; ++i)
+	{
+		uint32 Tile = 0;
+		uint8 PlaneAmount = 0;
+		Ar.SerializeIntPacked(Tile);
+		Ar << PlaneAmount;
+		if (Ar.IsError() || Tile >= static_cast<uint32>(TotalTileAmount))
+		{
+			return false;
+		}
+
+		// the saved planes replace all weights of the tile
+		const FIntRect Area = GetTileArea(Landscape, Tile);
+		for (FGroundTypeWeightPlane& Plane : Weights.Planes)
+		{
+			if (Plane.Weights.IsEmpty())
+			{
+				continue;
+			}
+
+			for (int32 Y = Area.Min.Y; Y < Area.Max.Y; ++Y)
+			{
+				FMemory::Memzero(&Plane.Weights[Area.Min.X + Y * RowLength], Area.Width());
+			}
+		}
+
+		TileWeights.SetNumUninitialized(Area.Area());
+		for (int32 TilePlane = 0; TilePlane < PlaneAmount; ++TilePlane)
+		{
+			uint32 SavedPlane = 0;
+			Ar.SerializeIntPacked(SavedPlane);
+			Ar.Serialize(TileWeights.GetData(), TileWeights.Num());
+			if (Ar.IsError())
+			{
+				return false;
+			}
+
+			const int32 Plane = PlaneMapping.IsValidIndex(SavedPlane) ? PlaneMapping[SavedPlane] : INDEX_NONE;
+			if (Plane == INDEX_NONE)
+			{
+				continue;
+			}
+
+			TArray<uint8>& PlaneWeights = Weights.GetOrAllocatePlane(Plane, VertexAmount);
+			for (int32 Y = Area.Min.Y; Y < Area.Max.Y; ++Y)
+			{
+				FMemory::Memcpy(&PlaneWeights[Area.Min.X + Y * RowLength],
+				                &TileWeights[(Y - Area.Min.Y) * Area.Width()], Area.Width());
+			}
+		}
+
+		OutEdits.EditedWeightTiles[Tile] = true;
+	}
+
+	if (WeightTileAmount > 0)
+	{
+		Weights.ReleaseEmptyPlanes();
+		Weights.UpdateDominantPlanes(VertexAmount);
+		OutEdits.bHasWeights = true;
+	}
+
+	return true;
+}
@@ -0,0 +1,232 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RuntimeLandscapeEditTrace.h"
+
+#include "RuntimeEditableLandscape.h"
+#include "RuntimeLandscape.h"
+
+#if RUNTIME_LANDSCAPE_TRACE_ENABLED
+UE_TRACE_CHANNEL_DEFINE(RuntimeLandscapeChannel)
+
+UE_TRACE_EVENT_BEGIN(RuntimeLandscape, EditBegin)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, EditId)
+	UE_TRACE_EVENT_FIELD(uint32, LandscapeId)
+	UE_TRACE_EVENT_FIELD(uint8, Type)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(RuntimeLandscape, EditQueued)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, EditId)
+	UE_TRACE_EVENT_FIELD(int32, ComponentIndex)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(RuntimeLandscape, RebuildStage)
+	UE_TRACE_EVENT_FIELD(uint64, StartCycle)
+	UE_TRACE_EVENT_FIELD(uint64, EndCycle)
+	UE_TRACE_EVENT_FIELD(int32, ComponentIndex)
+	UE_TRACE_EVENT_FIELD(uint8, Stage)
+	UE_TRACE_EVENT_FIELD(uint32[], EditIds)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(RuntimeLandscape, EditEnd)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, EditId)
+	UE_TRACE_EVENT_FIELD(double, LatencyMs)
+UE_TRACE_EVENT_END()
+#endif
+
+void FRuntimeLandscapeLatencyHistogram::AddSample(double LatencyMs)
+{
+	int32 Bucket = 0;
+	if (LatencyMs > MinLatencyMs)
+	{
+		Bucket = FMath::Min(FMath::CeilToInt(FMath::Loge(LatencyMs / MinLatencyMs) / FMath::Loge(BucketGrowth)),
+		                    BucketAmount - 1);
+	}
+
+	++Buckets[Bucket];
+	++SampleAmount;
+	MaxLatencyMs = FMath::Max(MaxLatencyMs, LatencyMs);
+}
+
+double FRuntimeLandscapeLatencyHistogram::GetPercentile(double Percentile) const
+{
+	if (SampleAmount == 0)
+	{
+		return 0.0;
+	}
+
+	const int64 TargetRank = FMath::Max<int64>(1, FMath::CeilToInt64(SampleAmount * Percentile / 100.0));
+	int64 Rank = 0;
+	for (int32 Bucket = 0; Bucket < BucketAmount; ++Bucket)
+	{
+		Rank += Buckets[Bucket];
+		if (Rank >= TargetRank)
+		{
+			// the bound of the bucket can be above all samples it contains
+			return FMath::Min(MinLatencyMs * FMath::Pow(BucketGrowth, Bucket), MaxLatencyMs);
+		}
+	}
+
+	return MaxLatencyMs;
+}
+
+void FRuntimeLandscapeLatencyHistogram::Reset()
+{
+	for (int64& Bucket : Buckets)
+	{
+		Bucket = 0;
+	}
+
+	SampleAmount = 0;
+	MaxLatencyMs = 0.0;
+}
+
+uint32 FRuntimeLandscapeEditTracker::BeginEdit(ERuntimeLandscapeEditType Type, const ARuntimeLandscape& Landscape)
+{
+	check(IsInGameThread());
+	if (EditDepth++ > 0)
+	{
+		return CurrentEditId;
+	}
+
+	// ids are unique across all landscapes, so the trace can correlate them without the landscape
+	static uint32 NextEditId = 0;
+	if (++NextEditId == 0)
+	{
+		++NextEditId;
+	}
+
+	CurrentEditId = NextEditId;
+	FPendingEdit& Edit = PendingEdits.Add(CurrentEditId);
+	Edit.StartCycles = FPlatformTime::Cycles64();
+	Edit.Type = Type;
+
+#if RUNTIME_LANDSCAPE_TRACE_ENABLED
+	UE_TRACE_LOG(RuntimeLandscape, EditBegin, RuntimeLandscapeChannel)
+		<< EditBegin.Cycle(Edit.StartCycles)
+		<< EditBegin.EditId(CurrentEditId)
+		<< EditBegin.LandscapeId(Landscape.GetUniqueID())
+		<< EditBegin.Type(static_cast<uint8>(Type));
+#endif
+
+	return CurrentEditId;
+}
+
+void FRuntimeLandscapeEditTracker::EndEdit()
+{
+	check(EditDepth > 0);
+	if (--EditDepth > 0)
+	{
+		return;
+	}
+
+	// edits that did not queue a rebuild (i.e. painting without grass) are visible right away
+	const FPendingEdit* Edit = PendingEdits.Find(CurrentEditId);
+	if (Edit && Edit->RemainingComponents == 0)
+	{
+		FinishEdit(CurrentEditId, *Edit);
+	}
+
+	CurrentEditId = 0;
+}
+
+void FRuntimeLandscapeEditTracker::AttachEdit(int32 ComponentIndex, FRuntimeLandscapeEditIds& InOutEditIds)
+{
+	if (CurrentEditId == 0 || InOutEditIds.Contains(CurrentEditId))
+	{
+		return;
+	}
+
+	InOutEditIds.Add(CurrentEditId);
+	++PendingEdits.FindChecked(CurrentEditId).RemainingComponents;
+
+#if RUNTIME_LANDSCAPE_TRACE_ENABLED
+	UE_TRACE_LOG(RuntimeLandscape, EditQueued, RuntimeLandscapeChannel)
+		<< EditQueued.Cycle(FPlatformTime::Cycles64())
+		<< EditQueued.EditId(CurrentEditId)
+		<< EditQueued.ComponentIndex(ComponentIndex);
+#endif
+}
+
+void FRuntimeLandscapeEditTracker::FinishEdits(TConstArrayView<uint32> EditIds)
+{
+	for (const uint32 EditId : EditIds)
+	{
+		FPendingEdit* Edit = PendingEdits.Find(EditId);
+		if (!Edit)
+		{
+			continue;
+		}
+
+		// the current edit can still attach components
+		if (--Edit->RemainingComponents == 0 && EditId != CurrentEditId)
+		{
+			FinishEdit(EditId, *Edit);
+		}
+	}
+}
+
+void FRuntimeLandscapeEditTracker::FinishEdit(uint32 EditId, const FPendingEdit& Edit)
+{
+	const uint64 EndCycles = FPlatformTime::Cycles64();
+	const double LatencyMs = FPlatformTime::ToMilliseconds64(EndCycles - Edit.StartCycles);
+	Latency.AddSample(LatencyMs);
+
+#if RUNTIME_LANDSCAPE_TRACE_ENABLED
+	UE_TRACE_LOG(RuntimeLandscape, EditEnd, RuntimeLandscapeChannel)
+		<< EditEnd.Cycle(EndCycles)
+		<< EditEnd.EditId(EditId)
+		<< EditEnd.LatencyMs(LatencyMs);
+#endif
+
+	CSV_CUSTOM_STAT(RuntimeLandscape, EditLatencyMs, static_cast<float>(LatencyMs), ECsvCustomStatOp::Max);
+	PendingEdits.Remove(EditId);
+}
+
+FRuntimeLandscapeEditScope::FRuntimeLandscapeEditScope(ARuntimeLandscape& Landscape, ERuntimeLandscapeEditType Type)
+	: Tracker(Landscape.GetEditTracker())
+{
+	Tracker.BeginEdit(Type, Landscape);
+}
+
+FRuntimeLandscapeEditScope::~FRuntimeLandscapeEditScope()
+{
+	Tracker.EndEdit();
+}
+
+#if RUNTIME_LANDSCAPE_TRACE_ENABLED
+FRuntimeLandscapeStageTraceScope::FRuntimeLandscapeStageTraceScope(ERuntimeLandscapeTraceStage InStage,
+                                                                   int32 InComponentIndex,
+                                                                   TConstArrayView<uint32> InEditIds)
+	: StartCycles(0), ComponentIndex(InComponentIndex), Stage(InStage),
+	  bIsEnabled(UE_TRACE_CHANNELEXPR_IS_ENABLED(RuntimeLandscapeChannel))
+{
+	if (bIsEnabled)
+	{
+		EditIds.Append(InEditIds.GetData(), InEditIds.Num());
+		StartCycles = FPlatformTime::Cycles64();
+	}
+}
+
+FRuntimeLandscapeStageTraceScope::~FRuntimeLandscapeStageTraceScope()
+{
+	if (bIsEnabled)
+	{
+		Output(Stage, ComponentIndex, EditIds, StartCycles);
+	}
+}
+
+void FRuntimeLandscapeStageTraceScope::Output(ERuntimeLandscapeTraceStage Stage, int32 ComponentIndex,
+                                              TConstArrayView<uint32> EditIds, uint64 StartCycles)
+{
+	UE_TRACE_LOG(RuntimeLandscape, RebuildStage, RuntimeLandscapeChannel)
+		<< RebuildStage.StartCycle(StartCycles)
+		<< RebuildStage.EndCycle(FPlatformTime::Cycles64())
+		<< RebuildStage.ComponentIndex(ComponentIndex)
+		<< RebuildStage.Stage(static_cast<uint8>(Stage))
+		<< RebuildStage.EditIds(EditIds.GetData(), EditIds.Num());
+}
+#endif
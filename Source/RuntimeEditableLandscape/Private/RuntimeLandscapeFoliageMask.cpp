@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RuntimeLandscapeFoliageMask.h"
+
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Runtime/Foliage/Public/InstancedFoliageActor.h"
+
+void FRuntimeLandscapeFoliageMask::Initialize(const AInstancedFoliageActor& Foliage, const FBox2D& InArea,
+                                              int32 InCellAmount)
+{
+	RestoreAll();
+	MaskedFoliage.Empty();
+	Area = InArea;
+	CellAmount = FMath::Max(InCellAmount, 1);
+	CellSize = Area.GetSize() / CellAmount;
+	bIsInitialized = true;
+
+	const FBox QueryBox = FBox(FVector(Area.Min, -UE_OLD_WORLD_MAX), FVector(Area.Max, UE_OLD_WORLD_MAX));
+	for (const auto& FoliageInfo : Foliage.GetFoliageInfos())
+	{
+		UHierarchicalInstancedStaticMeshComponent* FoliageComp = FoliageInfo.Value->GetComponent();
+		if (!FoliageComp)
+		{
+			continue;
+		}
+
+		// only collect instances whose origin is inside the area, so neighboring areas don't share instances
+		TArray<int32> Instances;
+		TArray<FTransform> Transforms;
+		TArray<int32> InstanceCells;
+		for (const int32 Instance : FoliageComp->GetInstancesOverlappingBox(QueryBox))
+		{
+			FTransform InstanceTransform;
+			FoliageComp->GetInstanceTransform(Instance, InstanceTransform, true);
+			const FVector2D Location = FVector2D(InstanceTransform.GetLocation());
+			if (Location.X < Area.Min.X || Location.Y < Area.Min.Y || Location.X >= Area.Max.X
+				|| Location.Y >= Area.Max.Y)
+			{
+				continue;
+			}
+
+			const FIntPoint Cell = GetCell(Location);
+			Instances.Add(Instance);
+			Transforms.Add(InstanceTransform);
+			InstanceCells.Add(Cell.X + Cell.Y * CellAmount);
+		}
+
+		if (Instances.IsEmpty())
+		{
+			continue;
+		}
+
+		// sort the instances by cell
+		FMaskedFoliage& Masked = MaskedFoliage.AddDefaulted_GetRef();
+		Masked.FoliageComponent = FoliageComp;
+		Masked.CellOffsets.SetNumZeroed(CellAmount * CellAmount + 1);
+		for (const int32 Cell : InstanceCells)
+		{
+			++Masked.CellOffsets[Cell + 1];
+		}
+
+		for (int32 Cell = 1; Cell < Masked.CellOffsets.Num(); ++Cell)
+		{
+			Masked.CellOffsets[Cell] += Masked.CellOffsets[Cell - 1];
+		}
+
+		Masked.Instances.SetNumUninitialized(Instances.Num());
+		Masked.OriginalTransforms.SetNumUninitialized(Instances.Num());
+		Masked.HiddenInstances.Init(false, Instances.Num());
+		TArray<int32> Cursors(Masked.CellOffsets.GetData(), CellAmount * CellAmount);
+		for (int32 i = 0; i < Instances.Num(); ++i)
+		{
+			const int32 Entry = Cursors[InstanceCells[i]]++;
+			Masked.Instances[Entry] = Instances[i];
+			Masked.OriginalTransforms[Entry] = Transforms[i];
+		}
+	}
+}
+
+int32 FRuntimeLandscapeFoliageMask::Update(const FBox2D& ChangedArea, TFunctionRef<bool(const FVector2D&)> IsMasked)
+{
+	if (!ChangedArea.bIsValid || !ChangedArea.Intersect(Area))
+	{
+		return 0;
+	}
+
+	const FIntPoint MinCell = GetCell(ChangedArea.Min);
+	const FIntPoint MaxCell = GetCell(ChangedArea.Max);
+	int32 ChangedInstanceAmount = 0;
+	for (FMaskedFoliage& Masked : MaskedFoliage)
+	{
+		if (!Masked.FoliageComponent.IsValid())
+		{
+			continue;
+		}
+
+		bool bHasChanged = false;
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+			{
+				const int32 Cell = X + Y * CellAmount;
+				for (int32 Entry = Masked.CellOffsets[Cell]; Entry < Masked.CellOffsets[Cell + 1]; ++Entry)
+				{
+					const FVector2D Location = FVector2D(Masked.OriginalTransforms[Entry].GetLocation());
+					if (!ChangedArea.IsInside(Location))
+					{
+						continue;
+					}
+
+					const bool bHide = IsMasked(Location);
+					if (Masked.HiddenInstances[Entry] != bHide)
+					{
+						SetInstanceHidden(Masked, Entry, bHide);
+						bHasChanged = true;
+						++ChangedInstanceAmount;
+					}
+				}
+			}
+		}
+
+		if (bHasChanged)
+		{
+			Masked.FoliageComponent->MarkRenderStateDirty();
+		}
+	}
+
+	return ChangedInstanceAmount;
+}
+
+void FRuntimeLandscapeFoliageMask::RestoreAll()
+{
+	for (FMaskedFoliage& Masked : MaskedFoliage)
+	{
+		if (!Masked.FoliageComponent.IsValid())
+		{
+			continue;
+		}
+
+		bool bHasChanged = false;
+		for (int32 Entry = 0; Entry < Masked.HiddenInstances.Num(); ++Entry)
+		{
+			if (Masked.HiddenInstances[Entry])
+			{
+				SetInstanceHidden(Masked, Entry, false);
+				bHasChanged = true;
+			}
+		}
+
+		if (bHasChanged)
+		{
+			Masked.FoliageComponent->MarkRenderStateDirty();
+		}
+	}
+}
+
+void FRuntimeLandscapeFoliageMask::SetInstanceHidden(FMaskedFoliage& Foliage, int32 Entry, bool bHidden)
+{
+	Foliage.HiddenInstances[Entry] = bHidden;
+
+	// hidden instances are scaled to zero, so their indices stay valid
+	FTransform InstanceTransform = Foliage.OriginalTransforms[Entry];
+	if (bHidden)
+	{
+		InstanceTransform.SetScale3D(FVector::ZeroVector);
+	}
+
+	Foliage.FoliageComponent->UpdateInstanceTransform(Foliage.Instances[Entry], InstanceTransform, true, false, true);
+}
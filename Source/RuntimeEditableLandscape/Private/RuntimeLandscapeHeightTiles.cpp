@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RuntimeLandscapeHeightTiles.h"
+
+void FRuntimeLandscapeHeightTiles::Initialize(const FIntVector2& InVertexAmount)
+{
+	if (VertexAmount == InVertexAmount)
+	{
+		return;
+	}
+
+	VertexAmount = InVertexAmount;
+	TileAmountX = FMath::DivideAndRoundUp(VertexAmount.X, FRuntimeLandscapeHeightTile::TileSize);
+	const int32 TileAmountY = FMath::DivideAndRoundUp(VertexAmount.Y, FRuntimeLandscapeHeightTile::TileSize);
+	Tiles.Empty();
+	Tiles.SetNum(TileAmountX * TileAmountY);
+	EditedTileAmount = 0;
+}
+
+void FRuntimeLandscapeHeightTiles::Reset()
+{
+	for (TRefCountPtr<FRuntimeLandscapeHeightTile>& Tile : Tiles)
+	{
+		Tile.SafeRelease();
+	}
+
+	EditedTileAmount = 0;
+}
+
+void FRuntimeLandscapeHeightTiles::SetHeight(int32 VertexIndex, uint16 Height, const TArray<uint16>& InitialHeights)
+{
+	int32 LocalIndex;
+	const int32 TileIndex = GetTileIndex(VertexIndex, LocalIndex);
+	const FRuntimeLandscapeHeightTile* Tile = Tiles[TileIndex];
+	const uint16 CurrentHeight = Tile ? Tile->Heights[LocalIndex] : InitialHeights[VertexIndex];
+	if (CurrentHeight != Height)
+	{
+		GetMutableTile(TileIndex, InitialHeights).Heights[LocalIndex] = Height;
+	}
+}
+
+void FRuntimeLandscapeHeightTiles::SetHole(int32 VertexIndex, bool bIsHole, const TArray<uint16>& InitialHeights)
+{
+	int32 LocalIndex;
+	const int32 TileIndex = GetTileIndex(VertexIndex, LocalIndex);
+	const FRuntimeLandscapeHeightTile* Tile = Tiles[TileIndex];
+	const bool bCurrentIsHole = Tile && Tile->Holes[LocalIndex];
+	if (bCurrentIsHole != bIsHole)
+	{
+		GetMutableTile(TileIndex, InitialHeights).Holes[LocalIndex] = bIsHole;
+	}
+}
+
+void FRuntimeLandscapeHeightTiles::GetHoles(TSet<int32>& OutVerticesInHole) const
+{
+	constexpr int32 TileSize = FRuntimeLandscapeHeightTile::TileSize;
+	for (int32 TileIndex = 0; TileIndex < Tiles.Num(); ++TileIndex)
+	{
+		const FRuntimeLandscapeHeightTile* Tile = Tiles[TileIndex];
+		if (!Tile)
+		{
+			continue;
+		}
+
+		const int32 FirstX = TileIndex % TileAmountX * TileSize;
+		const int32 FirstY = TileIndex / TileAmountX * TileSize;
+		for (int32 LocalIndex = 0; LocalIndex < TileSize * TileSize; ++LocalIndex)
+		{
+			const int32 X = FirstX + LocalIndex % TileSize;
+			const int32 Y = FirstY + LocalIndex / TileSize;
+			if (Tile->Holes[LocalIndex] && X < VertexAmount.X && Y < VertexAmount.Y)
+			{
+				OutVerticesInHole.Add(X + Y * VertexAmount.X);
+			}
+		}
+	}
+}
+
+FRuntimeLandscapeHeightTile& FRuntimeLandscapeHeightTiles::GetMutableTile(int32 TileIndex,
+                                                                         const TArray<uint16>& InitialHeights)
+{
+	check(Tiles.IsValidIndex(TileIndex));
+	TRefCountPtr<FRuntimeLandscapeHeightTile>& Tile = Tiles[TileIndex];
+	if (!Tile)
+	{
+		constexpr int32 TileSize = FRuntimeLandscapeHeightTile::TileSize;
+		const int32 FirstX = TileIndex % TileAmountX * TileSize;
+		const int32 FirstY = TileIndex / TileAmountX * TileSize;
+
+		Tile = new FRuntimeLandscapeHeightTile();
+		for (int32 LocalIndex = 0; LocalIndex < TileSize * TileSize; ++LocalIndex)
+		{
+			const int32 X = FMath::Min(FirstX + LocalIndex % TileSize, VertexAmount.X - 1);
+			const int32 Y = FMath::Min(FirstY + LocalIndex / TileSize, VertexAmount.Y - 1);
+			Tile->Heights[LocalIndex] = InitialHeights[X + Y * VertexAmount.X];
+		}
+
+		++EditedTileAmount;
+	}
+	else if (Tile->GetRefCount() > 1)
+	{
+		// the tile is shared with a snapshot
+		FRuntimeLandscapeHeightTile* Copy = new FRuntimeLandscapeHeightTile();
+		Copy->Heights = Tile->Heights;
+		Copy->Holes = Tile->Holes;
+		Tile = Copy;
+	}
+
+	return *Tile;
+}
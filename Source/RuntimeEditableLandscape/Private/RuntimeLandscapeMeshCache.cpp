@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RuntimeLandscapeMeshCache.h"
+
+#include "LandscapeGrassType.h"
+#include "PackedNormal.h"
+#include "ProceduralMeshComponent.h"
+#include "Grass/GrassRuleTable.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Threads/RuntimeLandscapeRebuildManager.h"
+
+void FRuntimeLandscapeMeshCache::Store(const FRuntimeLandscapeRebuildBuffer& Buffer, const FGrassRuleTable& GrassRules,
+                                       bool bInHasGrass)
+{
+	Reset();
+
+	TArray<uint32> PackedNormals;
+	PackedNormals.SetNumUninitialized(Buffer.Normals.Num());
+	for (int32 i = 0; i < Buffer.Normals.Num(); ++i)
+	{
+		PackedNormals[i] = FPackedNormal(FVector3f(Buffer.Normals[i])).Vector.Packed;
+	}
+
+	// the tangent Y flip is stored in W
+	TArray<uint32> PackedTangents;
+	PackedTangents.SetNumUninitialized(Buffer.Tangents.Num());
+	for (int32 i = 0; i < Buffer.Tangents.Num(); ++i)
+	{
+		const FProcMeshTangent& Tangent = Buffer.Tangents[i];
+		PackedTangents[i] = FPackedNormal(FVector4f(FVector3f(Tangent.TangentX), Tangent.bFlipTangentY ? -1.0f : 1.0f))
+		                    .Vector.Packed;
+	}
+
+	FMemoryWriter Writer(Data);
+	Writer << PackedNormals;
+	Writer << PackedTangents;
+
+	int32 MeshAmount = 0;
+	for (const FLandscapeGrassMeshBuffer& MeshBuffer : Buffer.GrassData.MeshBuffers)
+	{
+		MeshAmount += MeshBuffer.InstanceTransformsRelative.IsEmpty() ? 0 : 1;
+	}
+
+	Writer << MeshAmount;
+	for (const FLandscapeGrassMeshBuffer& MeshBuffer : Buffer.GrassData.MeshBuffers)
+	{
+		if (MeshBuffer.InstanceTransformsRelative.IsEmpty())
+		{
+			continue;
+		}
+
+		// the variety is owned by the grass type of one of the rules
+		const ULandscapeGrassType* GrassType = nullptr;
+		int32 VarietyIndex = INDEX_NONE;
+		for (int32 Rule = 0; Rule < GrassRules.GetRuleAmount() && VarietyIndex == INDEX_NONE; ++Rule)
+		{
+			GrassType = GrassRules.GetRule(Rule).GrassType;
+			if (GrassType)
+			{
+				VarietyIndex = GrassType->GrassVarieties.IndexOfByPredicate([&MeshBuffer](const FGrassVariety& Variety)
+				{
+					return &Variety == MeshBuffer.GrassVariety;
+				});
+			}
+		}
+
+		if (!ensure(VarietyIndex != INDEX_NONE))
+		{
+			Reset();
+			return;
+		}
+
+		int32 GrassTypeIndex = GrassTypes.AddUnique(GrassType);
+		TArray<FTransform3f> Transforms;
+		Transforms.SetNumUninitialized(MeshBuffer.InstanceTransformsRelative.Num());
+		for (int32 i = 0; i < Transforms.Num(); ++i)
+		{
+			Transforms[i] = FTransform3f(MeshBuffer.InstanceTransformsRelative[i]);
+		}
+
+		TArray<int32> Vertices = MeshBuffer.InstanceVertices;
+		Writer << GrassTypeIndex;
+		Writer << VarietyIndex;
+		Writer << Transforms;
+		Writer << Vertices;
+	}
+
+	Version = CurrentVersion;
+	Hash = Buffer.InputHash;
+	bHasGrass = bInHasGrass;
+}
+
+bool FRuntimeLandscapeMeshCache::Restore(FRuntimeLandscapeRebuildBuffer& OutBuffer) const
+{
+	FMemoryReader Reader(Data);
+	TArray<uint32> PackedNormals;
+	TArray<uint32> PackedTangents;
+	Reader << PackedNormals;
+	Reader << PackedTangents;
+
+	const int32 VertexAmount = OutBuffer.VerticesRelative.Num();
+	if (Reader.IsError() || PackedNormals.Num() != VertexAmount || PackedTangents.Num() != VertexAmount)
+	{
+		return false;
+	}
+
+	OutBuffer.Normals.SetNumUninitialized(VertexAmount);
+	OutBuffer.Tangents.SetNumUninitialized(VertexAmount);
+	for (int32 i = 0; i < VertexAmount; ++i)
+	{
+		FPackedNormal Normal;
+		Normal.Vector.Packed = PackedNormals[i];
+		OutBuffer.Normals[i] = FVector(Normal.ToFVector3f());
+
+		FPackedNormal Tangent;
+		Tangent.Vector.Packed = PackedTangents[i];
+		const FVector4f TangentX = Tangent.ToFVector4f();
+		OutBuffer.Tangents[i] = FProcMeshTangent(FVector(FVector3f(TangentX)), TangentX.W < 0.0f);
+	}
+
+	OutBuffer.GrassData.Reset();
+	int32 MeshAmount = 0;
+	Reader << MeshAmount;
+	for (int32 Mesh = 0; Mesh < MeshAmount && !Reader.IsError(); ++Mesh)
+	{
+		int32 GrassTypeIndex = INDEX_NONE;
+		int32 VarietyIndex = INDEX_NONE;
+		TArray<FTransform3f> Transforms;
+		TArray<int32> Vertices;
+		Reader << GrassTypeIndex;
+		Reader << VarietyIndex;
+		Reader << Transforms;
+		Reader << Vertices;
+
+		// the grass type could have been edited without changing the hash if it is not used by a rule anymore
+		const ULandscapeGrassType* GrassType = GrassTypes.IsValidIndex(GrassTypeIndex)
+			                                       ? GrassTypes[GrassTypeIndex].Get()
+			                                       : nullptr;
+		if (!GrassType || !GrassType->GrassVarieties.IsValidIndex(VarietyIndex) || Transforms.Num() != Vertices.Num())
+		{
+			return false;
+		}
+
+		FLandscapeGrassMeshBuffer& MeshBuffer = OutBuffer.GrassData.FindOrAddMeshBuffer(
+			GrassType->GrassVarieties[VarietyIndex]);
+		MeshBuffer.InstanceTransformsRelative.SetNumUninitialized(Transforms.Num());
+		for (int32 i = 0; i < Transforms.Num(); ++i)
+		{
+			MeshBuffer.InstanceTransformsRelative[i] = FTransform(Transforms[i]);
+		}
+
+		MeshBuffer.InstanceVertices = MoveTemp(Vertices);
+	}
+
+	return !Reader.IsError();
+}
+
+void FRuntimeLandscapeMeshCache::Reset()
+{
+	Version = INDEX_NONE;
+	Hash = 0;
+	bHasGrass = false;
+	GrassTypes.Empty();
+	Data.Empty();
+}
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RuntimeLandscapeSubsystem.h"
+
+#include "RuntimeLandscape.h"
+
+void URuntimeLandscapeSubsystem::RegisterLandscape(ARuntimeLandscape* Landscape)
+{
+	check(Landscape);
+	UnregisterLandscape(Landscape);
+
+	const FBox2D Bounds = Landscape->GetWorldBounds();
+	const int32 Id = Landscapes.Add({Landscape, Bounds});
+
+	FIntPoint FirstCell;
+	FIntPoint LastCell;
+	GetCellRange(Bounds, FirstCell, LastCell);
+	for (int32 Y = FirstCell.Y; Y <= LastCell.Y; ++Y)
+	{
+		for (int32 X = FirstCell.X; X <= LastCell.X; ++X)
+		{
+			Cells.FindOrAdd(FIntPoint(X, Y)).Add(Id);
+		}
+	}
+}
+
+void URuntimeLandscapeSubsystem::UnregisterLandscape(const ARuntimeLandscape* Landscape)
+{
+	for (auto It = Landscapes.CreateIterator(); It; ++It)
+	{
+		if (It->Landscape.Get() != Landscape)
+		{
+			continue;
+		}
+
+		FIntPoint FirstCell;
+		FIntPoint LastCell;
+		GetCellRange(It->Bounds, FirstCell, LastCell);
+		for (int32 Y = FirstCell.Y; Y <= LastCell.Y; ++Y)
+		{
+			for (int32 X = FirstCell.X; X <= LastCell.X; ++X)
+			{
+				const FIntPoint Cell(X, Y);
+				TArray<int32, TInlineAllocator<1>>* CellLandscapes = Cells.Find(Cell);
+				if (CellLandscapes)
+				{
+					CellLandscapes->RemoveSingleSwap(It.GetIndex());
+					if (CellLandscapes->IsEmpty())
+					{
+						Cells.Remove(Cell);
+					}
+				}
+			}
+		}
+
+		It.RemoveCurrent();
+	}
+}
+
+void URuntimeLandscapeSubsystem::GetLandscapesInArea(const FBox2D& Area, TArray<ARuntimeLandscape*>& OutLandscapes) const
+{
+	OutLandscapes.Reset();
+	if (!Area.bIsValid)
+	{
+		return;
+	}
+
+	FIntPoint FirstCell;
+	FIntPoint LastCell;
+	GetCellRange(Area, FirstCell, LastCell);
+	for (int32 Y = FirstCell.Y; Y <= LastCell.Y; ++Y)
+	{
+		for (int32 X = FirstCell.X; X <= LastCell.X; ++X)
+		{
+			const TArray<int32, TInlineAllocator<1>>* CellLandscapes = Cells.Find(FIntPoint(X, Y));
+			if (!CellLandscapes)
+			{
+				continue;
+			}
+
+			for (const int32 Id : *CellLandscapes)
+			{
+				const FRegisteredLandscape& Entry = Landscapes[Id];
+				ARuntimeLandscape* Landscape = Entry.Landscape.Get();
+				if (Landscape && Entry.Bounds.Intersect(Area))
+				{
+					OutLandscapes.AddUnique(Landscape);
+				}
+			}
+		}
+	}
+}
+
+void URuntimeLandscapeSubsystem::GetCellRange(const FBox2D& Area, FIntPoint& OutFirstCell, FIntPoint& OutLastCell)
+{
+	OutFirstCell = FIntPoint(FMath::FloorToInt(Area.Min.X / CellSize), FMath::FloorToInt(Area.Min.Y / CellSize));
+	OutLastCell = FIntPoint(FMath::FloorToInt(Area.Max.X / CellSize), FMath::FloorToInt(Area.Max.Y / CellSize));
+}
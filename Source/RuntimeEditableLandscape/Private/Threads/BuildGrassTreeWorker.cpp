@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Threads/BuildGrassTreeWorker.h"
+
+#include "RuntimeEditableLandscape.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Threads/RuntimeLandscapeRebuildManager.h"
+
+FBuildGrassTreeWorker::FBuildGrassTreeWorker(URuntimeLandscapeRebuildManager* RebuildManager,
+                                             FRuntimeLandscapeRebuildSlot* Slot)
+{
+	this->RebuildManager = RebuildManager;
+	this->Slot = Slot;
+}
+
+FBuildGrassTreeWorker::~FBuildGrassTreeWorker()
+{
+	checkNoEntry();
+}
+
+void FBuildGrassTreeWorker::DoThreadedWork()
+{
+	RUNTIME_LANDSCAPE_SCOPE_STAT(BuildGrassTrees);
+	RUNTIME_LANDSCAPE_TRACE_STAGE(BuildGrassTrees, Slot->Component->GetComponentIndex(), Slot->DataBuffer.EditIds);
+	FLandscapeGrassTree& Tree = Slot->DataBuffer.GrassTrees[TreeIndex];
+	const FLandscapeGrassMeshBuffer& MeshBuffer = Slot->DataBuffer.GrassData.MeshBuffers[Tree.
+		MeshBufferIndex];
+	const int32 InstanceAmount = MeshBuffer.InstanceTransformsRelative.Num();
+
+	TArray<FMatrix> InstanceMatrices;
+	InstanceMatrices.SetNumUninitialized(InstanceAmount);
+	for (int32 i = 0; i < InstanceAmount; ++i)
+	{
+		InstanceMatrices[i] = MeshBuffer.InstanceTransformsRelative[i].ToMatrixWithScale();
+	}
+
+	TArray<float> CustomData;
+	TArray<int32> SortedInstances;
+	TArray<int32> InstanceReorderTable;
+	UHierarchicalInstancedStaticMeshComponent::BuildTreeAnyThread(InstanceMatrices, CustomData, 0, Tree.MeshBox,
+	                                                              Tree.ClusterTree, SortedInstances,
+	                                                              InstanceReorderTable, Tree.OcclusionLayerNum,
+	                                                              Tree.DesiredInstancesPerLeaf, false);
+
+	// the prebuilt tree expects the instances in sorted order
+	Tree.InstanceData.SetNumUninitialized(InstanceAmount);
+	Tree.SortedTransforms.SetNumUninitialized(InstanceAmount);
+	Tree.SortedVertices.SetNumUninitialized(InstanceAmount);
+	for (int32 i = 0; i < InstanceAmount; ++i)
+	{
+		const int32 SourceIndex = SortedInstances[i];
+		Tree.InstanceData[i] = FInstancedStaticMeshInstanceData(InstanceMatrices[SourceIndex]);
+		Tree.SortedTransforms[i] = MeshBuffer.InstanceTransformsRelative[SourceIndex];
+		Tree.SortedVertices[i] = MeshBuffer.InstanceVertices[SourceIndex];
+	}
+
+	RebuildManager->NotifyRunnerFinished(*Slot);
+}
@@ -4,14 +4,17 @@
 #include "Threads/GenerateAdditionalVertexDataWorker.h"
 
 #include "LandscapeGrassType.h"
+#include "RuntimeEditableLandscape.h"
 #include "RuntimeLandscapeComponent.h"
-#include "Kismet/KismetMathLibrary.h"
+#include "RuntimeLandscapeKernels.h"
+#include "Algo/BinarySearch.h"
 #include "Threads/RuntimeLandscapeRebuildManager.h"
 
 FGenerateAdditionalVertexDataWorker::FGenerateAdditionalVertexDataWorker(
-	URuntimeLandscapeRebuildManager* RebuildManager)
+	URuntimeLandscapeRebuildManager* RebuildManager, FRuntimeLandscapeRebuildSlot* Slot)
 {
 	this->RebuildManager = RebuildManager;
+	this->Slot = Slot;
 }
 
 FGenerateAdditionalVertexDataWorker::~FGenerateAdditionalVertexDataWorker()
@@ -24,164 +27,191 @@ void FGenerateAdditionalVertexDataWorker::GenerateGrassDataForVertex(const int32
 	// Don't add grass at first row or column, since it overlaps with the last row or column of neighboring component
 	if (YCoordinate == 0 || X == 0)
 	{
-		RebuildManager->DataBuffer.AdditionalData[VertexIndex].ClearData();
 		return;
 	}
 
-	const FGrassTypeSettings* SelectedGrass = nullptr;
-	float HighestWeight = 0;
+	const int32 Rule = SelectGrassRule(X, Slot->DataBuffer.VerticesRelative[VertexIndex].Z,
+	                                   Slot->DataBuffer.Normals[VertexIndex]);
 
-	bool bIsLayerApplied = false;
-	for (const auto& LayerWeightData : RebuildManager->Landscape->GetGroundTypeLayerWeightsAtVertexCoordinates(
-		     RebuildManager->CurrentComponent->GetComponentIndex(), X, YCoordinate))
+	// if the same grass would be selected on the previous terrain, only move the existing instances
+	if (Slot->DataBuffer.bReprojectGrass)
 	{
-		if (LayerWeightData.Value >= HighestWeight && LayerWeightData.Value > 0.2f)
+		const URuntimeLandscapeComponent* Component = Slot->Component;
+		const int32 PreviousRule = SelectGrassRule(X, Component->GetBuiltHeightRelative(VertexIndex),
+		                                           Component->GrassVertexNormals[VertexIndex]);
+		if (PreviousRule == Rule)
 		{
-			HighestWeight = LayerWeightData.Value;
-			SelectedGrass = &LayerWeightData.Key->GrassTypeSettings;
-			bIsLayerApplied = true;
+			ReprojectGrassAtVertex(VertexIndex);
+			return;
 		}
 	}
 
-	// if no layer is applied, check if height based grass should be displayed
-	if (!bIsLayerApplied)
+	if (Rule != INDEX_NONE)
 	{
-		const float VertexHeight = (RebuildManager->DataBuffer.VerticesRelative[VertexIndex]
-			+ RebuildManager->CurrentComponent->GetComponentLocation()).Z;
-
-		for (const FHeightBasedLandscapeData& HeightBasedData : RebuildManager->CurrentComponent->
-		     GetParentLandscape()->GetHeightBasedData())
-		{
-			if (HeightBasedData.MinHeight < VertexHeight && HeightBasedData.MaxHeight > VertexHeight)
-			{
-				SelectedGrass = &HeightBasedData.Grass;
-				HighestWeight = 1.0f;
-			}
-		}
+		// ground type grass is scaled by the weight, height based grass has full weight
+		const float Weight = GrassRules->IsGroundTypeRule(Rule) ? RowDominantWeights[X] / 255.0f : 1.0f;
+		GenerateGrassTransformsAtVertex(GrassRules->GetRule(Rule).GrassType, VertexIndex, Weight);
 	}
+}
 
-	// clean data carried over from previous run
-	RebuildManager->DataBuffer.AdditionalData[VertexIndex].ClearData();
-
-	GenerateGrassTransformsAtVertex(SelectedGrass, VertexIndex, HighestWeight);
+int32 FGenerateAdditionalVertexDataWorker::SelectGrassRule(int32 X, float VertexHeightRelative,
+                                                           const FVector& Normal) const
+{
+	const int32 Rule = GrassRules->SelectRule(RowDominantPlanes[X], RowDominantWeights[X],
+	                                          VertexHeightRelative + ComponentHeight);
+	return Rule != INDEX_NONE && GrassRules->IsSlopeAllowed(Rule, Normal) ? Rule : INDEX_NONE;
 }
 
-void FGenerateAdditionalVertexDataWorker::GenerateGrassTransformsAtVertex(const FGrassTypeSettings* SelectedGrass,
-                                                                          const int32 VertexIndex,
-                                                                          float Weight) const
+void FGenerateAdditionalVertexDataWorker::ReprojectGrassAtVertex(int32 VertexIndex)
 {
-	if (!SelectedGrass || !SelectedGrass->GrassType)
+	const URuntimeLandscapeComponent* Component = Slot->Component;
+	const float VertexHeight = Slot->DataBuffer.VerticesRelative[VertexIndex].Z;
+	const FQuat AlignmentDelta = FQuat::FindBetweenNormals(Component->GrassVertexNormals[VertexIndex],
+	                                                       Slot->DataBuffer.Normals[VertexIndex]);
+
+	for (int32 i = 0; i < Component->GeneratedGrass.MeshBuffers.Num(); ++i)
 	{
-		return;
-	}
+		const FLandscapeGrassMeshBuffer& PreviousBuffer = Component->GeneratedGrass.MeshBuffers[i];
+		int32& Cursor = PreviousGrassCursors[i];
+		while (Cursor < PreviousBuffer.InstanceVertices.Num() && PreviousBuffer.InstanceVertices[Cursor] < VertexIndex)
+		{
+			++Cursor;
+		}
 
+		if (Cursor == PreviousBuffer.InstanceVertices.Num() || PreviousBuffer.InstanceVertices[Cursor] != VertexIndex)
+		{
+			continue;
+		}
 
-	const FVector& Normal = RebuildManager->DataBuffer.Normals[VertexIndex];
+		FLandscapeGrassMeshBuffer& MeshBuffer = GrassData.FindOrAddMeshBuffer(*PreviousBuffer.GrassVariety);
+		for (; Cursor < PreviousBuffer.InstanceVertices.Num() && PreviousBuffer.InstanceVertices[Cursor] == VertexIndex;
+		       ++Cursor)
+		{
+			// instances are placed at vertex height and aligned to the vertex normal
+			FTransform InstanceTransformRelative = PreviousBuffer.InstanceTransformsRelative[Cursor];
+			FVector Location = InstanceTransformRelative.GetLocation();
+			Location.Z = VertexHeight;
+			InstanceTransformRelative.SetLocation(Location);
+			InstanceTransformRelative.SetRotation(AlignmentDelta * InstanceTransformRelative.GetRotation());
+			MeshBuffer.InstanceTransformsRelative.Add(InstanceTransformRelative);
+			MeshBuffer.InstanceVertices.Add(VertexIndex);
+		}
+	}
+}
 
-	float Roll;
-	float Pitch;
-	UKismetMathLibrary::GetSlopeDegreeAngles(FVector::RightVector, Normal, FVector::UpVector, Pitch, Roll);
-	// don't generate grass data if the vertex normal is steeper than the max
-	if (SelectedGrass->MaxSlopeAngle > 0.0f
-		&& (FMath::Abs(Roll) > SelectedGrass->MaxSlopeAngle
-			|| FMath::Abs(Pitch) > SelectedGrass->MaxSlopeAngle))
+void FGenerateAdditionalVertexDataWorker::GenerateGrassTransformsAtVertex(const ULandscapeGrassType* GrassType,
+                                                                          const int32 VertexIndex,
+                                                                          float Weight)
+{
+	if (!GrassType)
 	{
 		return;
 	}
 
-	FRotator SurfaceAlignmentRotation = UKismetMathLibrary::MakeRotFromZ(Normal);
-	const FVector& VertexRelativeLocation = RebuildManager->DataBuffer.VerticesRelative[VertexIndex];
-	FLandscapeAdditionalData& AdditionalData = RebuildManager->DataBuffer.AdditionalData[VertexIndex];
+	const FQuat SurfaceAlignment = FQuat::FindBetweenNormals(FVector::UpVector,
+	                                                         Slot->DataBuffer.Normals[VertexIndex]);
+	const FVector& VertexRelativeLocation = Slot->DataBuffer.VerticesRelative[VertexIndex];
+	FRandomStream RandomStream = GetVertexRandomStream(VertexIndex);
+	const ARuntimeLandscape* Landscape = RebuildManager->Landscape;
 
-	for (const FGrassVariety& Variety : SelectedGrass->GrassType->GrassVarieties)
+	for (const FGrassVariety& Variety : GrassType->GrassVarieties)
 	{
-		FLandscapeGrassVertexData& GrassData = AdditionalData.GrassData.FindOrAdd(Variety.GrassMesh);
-
-		float InstanceCount = RebuildManager->Landscape->GetAreaPerSquare() * Variety.GetDensity() * 0.000001f *
-			Weight;
-		int32 RemainingInstanceCount = FMath::FloorToInt(InstanceCount);
-
-		// round up based on decimal remainder
-		float Remainder = InstanceCount - RemainingInstanceCount;
-		if (FMath::RandRange(0.0f, 1.0f) < Remainder)
+		if (!Variety.GrassMesh)
 		{
-			++RemainingInstanceCount;
+			continue;
 		}
 
-		GrassData.InstanceTransformsRelative.Empty(RemainingInstanceCount);
-		GrassData.GrassVariety = Variety;
+		const RuntimeLandscapeKernels::FGrassVariety KernelVariety = MakeKernelVariety(Variety);
+		const int32 InstanceAmount = RuntimeLandscapeKernels::GetGrassInstanceAmount(
+			KernelVariety, Landscape->GetAreaPerSquare(), Weight, RandomStream);
+		if (InstanceAmount < 1)
+		{
+			continue;
+		}
 
-		while (RemainingInstanceCount > 0)
+		FLandscapeGrassMeshBuffer& MeshBuffer = GrassData.FindOrAddMeshBuffer(Variety);
+		const int32 FirstInstance = MeshBuffer.InstanceTransformsRelative.AddUninitialized(InstanceAmount);
+		RuntimeLandscapeKernels::PlaceGrassInstances(KernelVariety, VertexRelativeLocation, SurfaceAlignment,
+		                                             Landscape->GetQuadSideLength(), RandomStream,
+		                                             MakeArrayView(MeshBuffer.InstanceTransformsRelative).Slice(
+			                                             FirstInstance, InstanceAmount));
+		for (int32 i = 0; i < InstanceAmount; ++i)
 		{
-			FVector GrassLocationRelative;
-			GetRandomGrassLocation(VertexRelativeLocation, GrassLocationRelative);
-
-			FRotator Rotation;
-			GetRandomGrassRotation(Variety, Rotation);
-			
-			FVector Scale;
-			GetRandomGrassScale(Variety, Scale);
-
-			FTransform InstanceTransformRelative(Rotation, GrassLocationRelative, Scale);
-			InstanceTransformRelative.SetRotation(SurfaceAlignmentRotation.Quaternion() * Rotation.Quaternion());
-			GrassData.InstanceTransformsRelative.Add(InstanceTransformRelative);
-			--RemainingInstanceCount;
+			MeshBuffer.InstanceVertices.Add(VertexIndex);
 		}
 	}
 }
 
-void FGenerateAdditionalVertexDataWorker::GetRandomGrassRotation(const FGrassVariety& Variety,
-                                                                 FRotator& OutRotation) const
+FRandomStream FGenerateAdditionalVertexDataWorker::GetVertexRandomStream(int32 VertexIndex) const
 {
-	if (Variety.RandomRotation)
-	{
-		float RandomRotation = FMath::RandRange(-180.0f, 180.0f);
-		OutRotation = FRotator(0.0f, RandomRotation, 0.0f);
-	}
+	uint32 Seed = GetTypeHash(RebuildManager->Landscape->GetGrassSeed());
+	Seed = HashCombine(Seed, GetTypeHash(Slot->Component->GetComponentIndex()));
+	Seed = HashCombine(Seed, GetTypeHash(VertexIndex));
+	return FRandomStream(static_cast<int32>(Seed));
 }
 
-void FGenerateAdditionalVertexDataWorker::GetRandomGrassLocation(const FVector& VertexRelativeLocation,
-                                                                 FVector& OutGrassLocation) const
+RuntimeLandscapeKernels::FGrassVariety FGenerateAdditionalVertexDataWorker::MakeKernelVariety(
+	const FGrassVariety& Variety)
 {
-	float PosX = FMath::RandRange(-0.5f, 0.5f);
-	float PosY = FMath::RandRange(-0.5f, 0.5f);
-
-	float SideLength = RebuildManager->CurrentComponent->GetParentLandscape()->GetQuadSideLength();
-	OutGrassLocation = VertexRelativeLocation + FVector(PosX * SideLength, PosY * SideLength, 0.0f);
-}
+	RuntimeLandscapeKernels::FGrassVariety Result;
+	Result.Density = Variety.GetDensity();
+	Result.bRandomRotation = Variety.RandomRotation;
+	Result.ScaleX = Variety.ScaleX;
+	Result.ScaleY = Variety.ScaleY;
+	Result.ScaleZ = Variety.ScaleZ;
 
-void FGenerateAdditionalVertexDataWorker::GetRandomGrassScale(const FGrassVariety& Variety, FVector& OutScale) const
-{
 	switch (Variety.Scaling)
 	{
 	case EGrassScaling::Uniform:
-		OutScale = FVector(FMath::RandRange(Variety.ScaleX.Min, Variety.ScaleX.Max));
+		Result.Scaling = RuntimeLandscapeKernels::EGrassScaling::Uniform;
 		break;
 	case EGrassScaling::Free:
-		OutScale.X = FMath::RandRange(Variety.ScaleX.Min, Variety.ScaleX.Max);
-		OutScale.Y = FMath::RandRange(Variety.ScaleY.Min, Variety.ScaleY.Max);
-		OutScale.Z = FMath::RandRange(Variety.ScaleZ.Min, Variety.ScaleZ.Max);
+		Result.Scaling = RuntimeLandscapeKernels::EGrassScaling::Free;
 		break;
 	case EGrassScaling::LockXY:
-		OutScale.X = FMath::RandRange(Variety.ScaleX.Min, Variety.ScaleX.Max);
-		OutScale.Y = OutScale.X;
-		OutScale.Z = FMath::RandRange(Variety.ScaleZ.Min, Variety.ScaleZ.Max);
+		Result.Scaling = RuntimeLandscapeKernels::EGrassScaling::LockXY;
 		break;
 	default:
 		ensureMsgf(false, TEXT("Scaling mode is not yet supported!"));
-		OutScale = FVector::One();
+		Result.Scaling = RuntimeLandscapeKernels::EGrassScaling::Uniform;
+		Result.ScaleX = FFloatInterval(1.0f, 1.0f);
 	}
+
+	return Result;
 }
 
 void FGenerateAdditionalVertexDataWorker::DoThreadedWork()
 {
-	// skip first column of vertices (since it overlaps with last column of neighbor)
-	int32 VertexIndex = StartIndex;
-	for (int32 X = 0; X < RebuildManager->Landscape->GetComponentResolution().X + 1; ++X)
+	RUNTIME_LANDSCAPE_SCOPE_STAT(GenerateGrass);
+	RUNTIME_LANDSCAPE_TRACE_STAGE(GenerateGrass, Slot->Component->GetComponentIndex(), Slot->DataBuffer.EditIds);
+	GrassData.Reset();
+	if (Slot->Component->IsGrassEnabled())
 	{
-		GenerateGrassDataForVertex(VertexIndex, X);
-		++VertexIndex;
+		GrassRules = Slot->DataBuffer.GrassRules.Get();
+		ComponentHeight = Slot->Component->GetComponentLocation().Z;
+		const int32 RowLength = RebuildManager->Landscape->GetVertexAmountPerComponent().X;
+		RowDominantPlanes = MakeArrayView(Slot->DataBuffer.DominantGroundTypePlanes).Slice(StartIndex, RowLength);
+		RowDominantWeights = MakeArrayView(Slot->DataBuffer.DominantGroundTypeWeights).Slice(StartIndex, RowLength);
+
+		if (Slot->DataBuffer.bReprojectGrass)
+		{
+			// start at the first previous instance of the row in every mesh buffer
+			const FLandscapeGrassData& PreviousGrass = Slot->Component->GeneratedGrass;
+			PreviousGrassCursors.SetNumUninitialized(PreviousGrass.MeshBuffers.Num());
+			for (int32 i = 0; i < PreviousGrass.MeshBuffers.Num(); ++i)
+			{
+				PreviousGrassCursors[i] = Algo::LowerBound(PreviousGrass.MeshBuffers[i].InstanceVertices, StartIndex);
+			}
+		}
+
+		// skip first column of vertices (since it overlaps with last column of neighbor)
+		int32 VertexIndex = StartIndex;
+		for (int32 X = 0; X < RebuildManager->Landscape->GetComponentResolution().X + 1; ++X)
+		{
+			GenerateGrassDataForVertex(VertexIndex, X);
+			++VertexIndex;
+		}
 	}
 
-	RebuildManager->NotifyRunnerFinished(this);
+	RebuildManager->NotifyRunnerFinished(*Slot);
 }
@@ -4,12 +4,16 @@
 #include "Threads/GenerateVerticesWorker.h"
 
 #include "KismetProceduralMeshLibrary.h"
+#include "RuntimeEditableLandscape.h"
 #include "RuntimeLandscape.h"
+#include "RuntimeLandscapeKernels.h"
 #include "Threads/RuntimeLandscapeRebuildManager.h"
 
-FGenerateVerticesWorker::FGenerateVerticesWorker(URuntimeLandscapeRebuildManager* RebuildManager)
+FGenerateVerticesWorker::FGenerateVerticesWorker(URuntimeLandscapeRebuildManager* RebuildManager,
+                                                 FRuntimeLandscapeRebuildSlot* Slot)
 {
 	this->RebuildManager = RebuildManager;
+	this->Slot = Slot;
 }
 
 FGenerateVerticesWorker::~FGenerateVerticesWorker()
@@ -19,62 +23,36 @@ FGenerateVerticesWorker::~FGenerateVerticesWorker()
 
 void FGenerateVerticesWorker::DoThreadedWork()
 {
-	const TArray<float>& HeightValues = RebuildManager->DataBuffer.HeightValues;
+	RUNTIME_LANDSCAPE_SCOPE_STAT(BuildVertices);
+	RUNTIME_LANDSCAPE_TRACE_STAGE(BuildVertices, Slot->Component->GetComponentIndex(), Slot->DataBuffer.EditIds);
 	const ARuntimeLandscape* Landscape = RebuildManager->Landscape;
-	int32 VertexIndex = 0;
 	const FGenerationDataCache& DataCache = RebuildManager->GenerationDataCache;
-	FRuntimeLandscapeRebuildBuffer& DataBuffer = RebuildManager->DataBuffer;
-
-	// First row of vertices is handled differently
-	for (int32 X = 0; X <= Landscape->GetComponentResolution().X; X++)
+	FRuntimeLandscapeRebuildBuffer& DataBuffer = Slot->DataBuffer;
+
+	RuntimeLandscapeKernels::FVertexGrid Grid;
+	Grid.Resolution = FIntPoint(FMath::RoundToInt(Landscape->GetComponentResolution().X),
+	                            FMath::RoundToInt(Landscape->GetComponentResolution().Y));
+	Grid.VertexDistance = DataCache.VertexDistance;
+	Grid.UVIncrement = DataCache.UVIncrement;
+	Grid.UV1Scale = DataCache.UV1Scale;
+	Grid.UV1Offset = UV1Offset;
+	Grid.HeightOffset = -Landscape->GetParentHeight();
+	RuntimeLandscapeKernels::GenerateVertices(Grid, DataBuffer.HeightValues, DataBuffer.VerticesRelative,
+	                                          DataBuffer.UV0Coords, DataBuffer.UV1Coords);
+
+	// fall back to generating the data if the cache could not be read
+	if (DataBuffer.bIsRestoredFromCache && !RebuildManager->RestoreFromCache(*Slot))
 	{
-		const FVector Location(X * DataCache.VertexDistance, 0,
-		                       HeightValues[VertexIndex] - Landscape->GetParentHeight());
-		DataBuffer.VerticesRelative[VertexIndex] = Location;
-		const FVector2D UV0 = FVector2D(X * DataCache.UVIncrement, 0);
-		DataBuffer.UV0Coords[VertexIndex] = UV0;
-		DataBuffer.UV1Coords[VertexIndex] = UV0 * DataCache.UV1Scale + UV1Offset;
-		VertexIndex++;
+		DataBuffer.bIsRestoredFromCache = false;
 	}
 
-	for (int32 Y = 0; Y < Landscape->GetComponentResolution().Y; Y++)
+	if (!DataBuffer.bIsRestoredFromCache)
 	{
-		const float Y1 = Y + 1;
-		FVector Location(0, Y1 * DataCache.VertexDistance, HeightValues[VertexIndex] - Landscape->GetParentHeight());
-		DataBuffer.VerticesRelative[VertexIndex] = Location;
-
-		FVector2D UV0 = FVector2D(0, Y1 * DataCache.UVIncrement);
-		DataBuffer.UV0Coords[VertexIndex] = UV0;
-		DataBuffer.UV1Coords[VertexIndex] = UV0 * DataCache.UV1Scale + UV1Offset;
-		VertexIndex++;
-
-		// generate triangle strip in X direction
-		for (int32 X = 0; X < Landscape->GetComponentResolution().X; X++)
-		{
-			Location = FVector((X + 1) * DataCache.VertexDistance, Y1 * DataCache.VertexDistance,
-			                   HeightValues[VertexIndex] - Landscape->GetParentHeight());
-			DataBuffer.VerticesRelative[VertexIndex] = Location;
-
-			UV0 = FVector2D((X + 1) * DataCache.UVIncrement,
-			                Y1 * DataCache.UVIncrement);
-			DataBuffer.UV0Coords[VertexIndex] = UV0;
-			DataBuffer.UV1Coords[VertexIndex] = UV0 * DataCache.UV1Scale + UV1Offset;
-
-			VertexIndex++;
-
-			//
-			// const TSet<int32>& VerticesInHole = RebuildManager->CurrentComponent->VerticesInHole;
-			// if (VerticesInHole.Contains(T1) || VerticesInHole.Contains(T2) || VerticesInHole.Contains(T3) ||
-			// 	VerticesInHole.Contains(T2 + 1))
-			// {
-			// 	continue;
-			// }
-		}
+		RUNTIME_LANDSCAPE_SCOPE_STAT(Tangents);
+		UKismetProceduralMeshLibrary::CalculateTangentsForMesh(DataBuffer.VerticesRelative, DataBuffer.Triangles,
+		                                                       DataBuffer.UV0Coords, DataBuffer.Normals,
+		                                                       DataBuffer.Tangents);
 	}
 
-	UKismetProceduralMeshLibrary::CalculateTangentsForMesh(DataBuffer.VerticesRelative, DataBuffer.Triangles,
-	                                                       DataBuffer.UV0Coords, DataBuffer.Normals,
-	                                                       DataBuffer.Tangents);
-
-	RebuildManager->NotifyRunnerFinished(this);
+	RebuildManager->NotifyRunnerFinished(*Slot);
 }
@@ -5,6 +5,8 @@
 
 #include "RuntimeEditableLandscape.h"
 #include "RuntimeLandscapeComponent.h"
+#include "RuntimeLandscapeKernels.h"
+#include "Threads/BuildGrassTreeWorker.h"
 #include "Threads/GenerateAdditionalVertexDataWorker.h"
 #include "Threads/GenerateVerticesWorker.h"
 
@@ -13,20 +15,48 @@ URuntimeLandscapeRebuildManager::URuntimeLandscapeRebuildManager() : Super()
 	bTickInEditor = true;
 	PrimaryComponentTick.bCanEverTick = true;
 	PrimaryComponentTick.bStartWithTickEnabled = false;
-	PrimaryComponentTick.TickInterval = 0.1f;
+	PrimaryComponentTick.TickInterval = DefaultTickInterval;
 }
 
 void URuntimeLandscapeRebuildManager::QueueRebuild(URuntimeLandscapeComponent* ComponentToRebuild)
 {
-	if (CurrentComponent)
+	RebuildQueue.Enqueue(ComponentToRebuild);
+	++QueuedRebuildAmount;
+	FRuntimeEditableLandscapeModule::TrackRebuilds(1, 0);
+	if (bIsCollectingBulkBuild)
 	{
-		RebuildQueue.Enqueue(ComponentToRebuild);
+		++BulkBuildComponentAmount;
+		return;
 	}
-	else
+
+	// start right away if a slot is free, so single edits don't wait for the next tick
+	RebuildNextInQueue();
+}
+
+void URuntimeLandscapeRebuildManager::BeginBulkBuild()
+{
+	Initialize();
+
+	if (!bIsBulkBuilding)
 	{
-		CurrentComponent = ComponentToRebuild;
-		StartRebuild();
+		bIsBulkBuilding = true;
+		BulkBuildComponentAmount = 0;
+		BulkBuildFinishedAmount = 0;
+		BulkBuildStartTime = FPlatformTime::Seconds();
 	}
+
+	bIsCollectingBulkBuild = true;
+}
+
+void URuntimeLandscapeRebuildManager::EndBulkBuild()
+{
+	check(bIsCollectingBulkBuild);
+	bIsCollectingBulkBuild = false;
+
+	// commits are limited by the commit budget instead of the tick interval
+	MaxConcurrentRebuilds = FMath::Max(1, ThreadPool->GetNumThreads());
+	SetComponentTickInterval(0.0f);
+	RebuildNextInQueue();
 }
 
 void URuntimeLandscapeRebuildManager::InitializeGenerationCache()
@@ -36,146 +66,457 @@ void URuntimeLandscapeRebuildManager::InitializeGenerationCache()
 	GenerationDataCache.UVIncrement = 1 / Landscape->GetComponentResolution().X;
 }
 
-void URuntimeLandscapeRebuildManager::InitializeRunners()
+void URuntimeLandscapeRebuildManager::InitializeThreadPool()
 {
-	VertexRunner = new FGenerateVerticesWorker(this);
-	for (int32 i = 0; i < Landscape->GetComponentResolution().Y + 1; ++i)
-	{
-		FGenerateAdditionalVertexDataWorker* AdditionalDataRunner = new FGenerateAdditionalVertexDataWorker(this);
-		AdditionalDataRunners.Add(AdditionalDataRunner);
-	}
-
 	ThreadPool = FQueuedThreadPool::Allocate();
 	int32 NumThreadsInThreadPool = FPlatformMisc::NumberOfWorkerThreadsToSpawn();
 	verify(
 		ThreadPool->Create(NumThreadsInThreadPool, 32 * 1024, TPri_Normal, TEXT("Runtime Landscape rebuild thread")));
 }
 
-void URuntimeLandscapeRebuildManager::InitializeBuffer()
+void URuntimeLandscapeRebuildManager::InitializeSlot(FRuntimeLandscapeRebuildSlot& Slot)
 {
+	Slot.VertexRunner = new FGenerateVerticesWorker(this, &Slot);
+	for (int32 i = 0; i < Landscape->GetComponentResolution().Y + 1; ++i)
+	{
+		FGenerateAdditionalVertexDataWorker* AdditionalDataRunner = new FGenerateAdditionalVertexDataWorker(
+			this, &Slot);
+		Slot.AdditionalDataRunners.Add(AdditionalDataRunner);
+	}
+
 	int32 VertexAmount = Landscape->GetTotalVertexAmountPerComponent();
 
+	FRuntimeLandscapeRebuildBuffer& DataBuffer = Slot.DataBuffer;
 	DataBuffer = FRuntimeLandscapeRebuildBuffer();
 	DataBuffer.HeightValues.SetNumUninitialized(VertexAmount);
 	DataBuffer.VerticesRelative.SetNumUninitialized(VertexAmount);
 	DataBuffer.UV0Coords.SetNumUninitialized(VertexAmount);
 	DataBuffer.UV1Coords.SetNumUninitialized(VertexAmount);
 
-	// initialize the grass data with empty structs
-	DataBuffer.AdditionalData.Empty(VertexAmount);
-	for (int32 i = 0; i < VertexAmount; ++i)
-	{
-		DataBuffer.AdditionalData.Add(FLandscapeAdditionalData());
-	}
-
 	DataBuffer.Triangles = GenerateTriangleArray(nullptr);
 }
 
-TArray<int32> URuntimeLandscapeRebuildManager::GenerateTriangleArray(const TSet<int32>* HoleIndices) const
+SIZE_T FRuntimeLandscapeRebuildBuffer::GetAllocatedSize() const
 {
-	int32 EntryCount = Landscape->GetComponentResolution().X * Landscape->GetComponentResolution().Y * 6;
-
-	if (HoleIndices)
+	SIZE_T Result = HeightValues.GetAllocatedSize() + VerticesRelative.GetAllocatedSize() + Triangles.
+		GetAllocatedSize() + UV0Coords.GetAllocatedSize() + UV1Coords.GetAllocatedSize() + Normals.GetAllocatedSize()
+		+ Tangents.GetAllocatedSize() + GrassData.GetAllocatedSize() + GrassTrees.GetAllocatedSize()
+		+ DominantGroundTypePlanes.GetAllocatedSize() + DominantGroundTypeWeights.GetAllocatedSize();
+	for (const FLandscapeGrassTree& GrassTree : GrassTrees)
 	{
-		EntryCount -= HoleIndices->Num() * 6;
+		Result += GrassTree.InstanceData.GetAllocatedSize() + GrassTree.ClusterTree.GetAllocatedSize() + GrassTree.
+			SortedTransforms.GetAllocatedSize() + GrassTree.SortedVertices.GetAllocatedSize();
 	}
 
-	TArray<int32> Result;
-	Result.Reserve(EntryCount);
+	return Result;
+}
 
-	// initialize triangle array, since the generation algorithm is always the same, this will always be the same for each component
-	for (int32 Y = 0; Y < Landscape->GetComponentResolution().Y; ++Y)
+TArray<int32> URuntimeLandscapeRebuildManager::GenerateTriangleArray(const TSet<int32>* HoleIndices) const
+{
+	RUNTIME_LANDSCAPE_SCOPE_STAT(GenerateTriangles);
+	RuntimeLandscapeKernels::FVertexGrid Grid;
+	Grid.Resolution = FIntPoint(FMath::RoundToInt(Landscape->GetComponentResolution().X),
+	                            FMath::RoundToInt(Landscape->GetComponentResolution().Y));
+
+	// a mask is cheaper to test than the set, since every vertex is tested for up to 4 quads
+	TArray<bool> VerticesInHole;
+	if (HoleIndices && !HoleIndices->IsEmpty())
 	{
-		for (int32 X = 0; X < Landscape->GetComponentResolution().X; ++X)
+		VerticesInHole.Init(false, Grid.GetVertexAmount());
+		for (const int32 HoleIndex : *HoleIndices)
 		{
-			const int32 T1 = Y * (Landscape->GetComponentResolution().X + 1) + X;
-			const int32 T2 = T1 + Landscape->GetComponentResolution().X + 1;
-			const int32 T3 = T1 + 1;
-
-			if (HoleIndices && (HoleIndices->Contains(T1) || HoleIndices->Contains(T2) || HoleIndices->Contains(T3)
-				|| HoleIndices->Contains(T2 + 1)))
-			{
-				continue;
-			}
-
-			// add upper-left triangle
-			Result.Add(T1);
-			Result.Add(T2);
-			Result.Add(T3);
-
-			// add lower-right triangle
-			Result.Add(T3);
-			Result.Add(T2);
-			Result.Add(T2 + 1);
+			VerticesInHole[HoleIndex] = true;
 		}
 	}
 
+	// initialize triangle array, since the generation algorithm is always the same, this will always be the same for each component
+	TArray<int32> Result;
+	Result.SetNumUninitialized(Grid.GetTriangleIndexAmount());
+	const int32 IndexAmount = RuntimeLandscapeKernels::GenerateTriangles(Grid, VerticesInHole, Result);
+	Result.SetNum(IndexAmount, false);
+
 	return Result;
 }
 
-void URuntimeLandscapeRebuildManager::StartRebuild()
+bool URuntimeLandscapeRebuildManager::StartRebuild(FRuntimeLandscapeRebuildSlot& Slot)
 {
-	Initialize();
+	URuntimeLandscapeComponent* Component = Slot.Component;
+	FRuntimeLandscapeRebuildBuffer& DataBuffer = Slot.DataBuffer;
+	DataBuffer.EditIds = MoveTemp(Component->PendingEditIds);
+	Component->PendingEditIds.Reset();
+	RUNTIME_LANDSCAPE_TRACE_STAGE_SINCE(Queued, Component->Index, DataBuffer.EditIds, Component->QueuedCycles);
+
+	// the component was streamed out while it was queued
+	if (!Component->bIsStreamedIn)
+	{
+		Landscape->GetEditTracker().FinishEdits(DataBuffer.EditIds);
+		Component->bIsStale = false;
+		Component->bOnlyGrassIsStale = false;
+		Component->ReleaseStreamedOutData();
+		Slot.Component = nullptr;
+		return false;
+	}
 
 	UE_LOG(RuntimeEditableLandscape, Display, TEXT("Rebuilding Landscape component %s %i..."), *GetOwner()->GetName(),
-	       CurrentComponent->Index);
+	       Component->Index);
 
 	FIntVector2 SectionCoordinates;
-	Landscape->GetComponentCoordinates(CurrentComponent->Index, SectionCoordinates);
+	Landscape->GetComponentCoordinates(Component->Index, SectionCoordinates);
 	DataBuffer.UV1Offset = GenerationDataCache.UV1Scale * FVector2D(SectionCoordinates.X, SectionCoordinates.Y);
 
 	// ensure the section data is valid
-	if (!ensure(CurrentComponent->InitialHeightValues.Num() == Landscape->GetTotalVertexAmountPerComponent()))
+	if (!ensure(Component->InitialHeights.Num() == Landscape->GetTotalVertexAmountPerComponent()))
 	{
 		UE_LOG(RuntimeEditableLandscape, Warning,
 		       TEXT("Component %i could not generate valid data and will not be generated!"),
-		       CurrentComponent->Index);
-		return;
+		       Component->Index);
+		Landscape->GetEditTracker().FinishEdits(DataBuffer.EditIds);
+		Slot.Component = nullptr;
+		return false;
 	}
 
+	Component->bIsRebuilding = true;
 	DataBuffer.RebuildState = ERuntimeLandscapeRebuildState::RLRS_BuildVertices;
-	DataBuffer.HeightValues = CurrentComponent->InitialHeightValues;
+	DataBuffer.GrassRules = Landscape->GetGrassRulesSnapshot();
+	for (int32 VertexIndex = 0; VertexIndex < Component->InitialHeights.Num(); ++VertexIndex)
+	{
+		DataBuffer.HeightValues[VertexIndex] = Landscape->DequantizeHeight(Component->GetBaseHeight(VertexIndex));
+	}
 
 	// TODO: Clean up. Do I need vertex colors?
 	TArray<FColor> VertexColors;
 	// TODO: Apply layer data on VertexRunner
-	CurrentComponent->ApplyDataFromLayers(DataBuffer.HeightValues, VertexColors);
+	{
+		RUNTIME_LANDSCAPE_TRACE_STAGE(ApplyLayers, Component->Index, DataBuffer.EditIds);
+		Component->ApplyDataFromLayers(DataBuffer.HeightValues, VertexColors);
+	}
+
+	// the vertices are generated either way, the vertex runner restores the rest from the cache
+	DataBuffer.bIsRestoredFromCache = false;
+	if (Landscape->bUseMeshCache)
+	{
+		DataBuffer.InputHash = Component->CalculateMeshCacheHash(DataBuffer.HeightValues);
+		DataBuffer.bIsRestoredFromCache = Component->MeshCache.IsValid(DataBuffer.InputHash,
+		                                                               Component->IsGrassEnabled());
+	}
+
+	Slot.ActiveRunners = 1;
+	Slot.VertexRunner->QueueWork(DataBuffer.UV1Offset);
+	return true;
+}
 
-	ActiveRunners = 1;
-	VertexRunner->QueueWork(DataBuffer.UV1Offset);
-	SetComponentTickEnabled(true);
+bool URuntimeLandscapeRebuildManager::RestoreFromCache(FRuntimeLandscapeRebuildSlot& Slot) const
+{
+	RUNTIME_LANDSCAPE_SCOPE_STAT(MeshCache);
+	if (!Slot.Component->MeshCache.Restore(Slot.DataBuffer))
+	{
+		UE_LOG(RuntimeEditableLandscape, Warning, TEXT("Mesh cache of component %i could not be read!"),
+		       Slot.Component->Index);
+		return false;
+	}
+
+	return true;
 }
 
-void URuntimeLandscapeRebuildManager::StartGenerateAdditionalData()
+void URuntimeLandscapeRebuildManager::StartGenerateAdditionalData(FRuntimeLandscapeRebuildSlot& Slot)
 {
+	FRuntimeLandscapeRebuildBuffer& DataBuffer = Slot.DataBuffer;
 	DataBuffer.RebuildState = ERuntimeLandscapeRebuildState::RLRS_BuildAdditionalData;
+	DataBuffer.bReprojectGrass = Slot.Component->CanReprojectGrass();
+	DataBuffer.GrassWeightsVersion = Slot.Component->GroundTypeWeightsVersion;
+	Landscape->GetDominantGroundTypes(Slot.Component->Index, DataBuffer.DominantGroundTypePlanes,
+	                                  DataBuffer.DominantGroundTypeWeights);
 	int32 VertexIndex = 0;
 	// Start data generation runners
-	ActiveRunners = Landscape->GetComponentResolution().Y + 1;
+	Slot.ActiveRunners = Landscape->GetComponentResolution().Y + 1;
 
 	for (int32 Y = 0; Y < Landscape->GetComponentResolution().Y + 1; Y++)
 	{
-		AdditionalDataRunners[Y]->QueueWork(Y, VertexIndex, DataBuffer.UV1Offset);
+		Slot.AdditionalDataRunners[Y]->QueueWork(Y, VertexIndex, DataBuffer.UV1Offset);
 		VertexIndex += Landscape->GetComponentResolution().X + 1;
 	}
 }
 
+void URuntimeLandscapeRebuildManager::CollectGrassData(FRuntimeLandscapeRebuildSlot& Slot)
+{
+	Slot.DataBuffer.GrassData.Reset();
+	for (const FGenerateAdditionalVertexDataWorker* Runner : Slot.AdditionalDataRunners)
+	{
+		Slot.DataBuffer.GrassData.Append(Runner->GrassData);
+	}
+
+	[[maybe_unused]] const int32 InstanceAmount = Slot.DataBuffer.GrassData.GetInstanceAmount();
+	INC_DWORD_STAT_BY(STAT_RuntimeLandscapeGeneratedGrassInstances, InstanceAmount);
+	CSV_CUSTOM_STAT(RuntimeLandscape, GeneratedGrassInstances, InstanceAmount, ECsvCustomStatOp::Accumulate);
+}
+
+bool URuntimeLandscapeRebuildManager::StartBuildGrassTrees(FRuntimeLandscapeRebuildSlot& Slot)
+{
+	FRuntimeLandscapeRebuildBuffer& DataBuffer = Slot.DataBuffer;
+	DataBuffer.GrassTrees.Reset();
+	// clusters are shared between components and always patched on the game thread
+	if (Landscape->IsGrassClustered())
+	{
+		return false;
+	}
+
+	// the component owns the instanced meshes, so it creates the missing ones
+	TArray<int32> GrassMeshIndices;
+	Slot.Component->AddGrassMeshes(DataBuffer.GrassData, GrassMeshIndices);
+	for (int32 i = 0; i < DataBuffer.GrassData.MeshBuffers.Num(); ++i)
+	{
+		if (GrassMeshIndices[i] == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const FLandscapeGrassMeshBuffer& MeshBuffer = DataBuffer.GrassData.MeshBuffers[i];
+		const FRuntimeLandscapeGrassMesh& GrassMesh = Slot.Component->GetGrassMesh(GrassMeshIndices[i]);
+		if (GrassMesh.NeedsFullRebuild(MeshBuffer.InstanceTransformsRelative.Num()))
+		{
+			FLandscapeGrassTree& GrassTree = DataBuffer.GrassTrees.AddDefaulted_GetRef();
+			GrassTree.MeshBufferIndex = i;
+			GrassTree.DesiredInstancesPerLeaf = GrassMesh.InstancedMesh->DesiredInstancesPerLeaf();
+			GrassTree.MeshBox = MeshBuffer.GrassVariety->GrassMesh->GetBounds().GetBox();
+		}
+	}
+
+	if (DataBuffer.GrassTrees.IsEmpty())
+	{
+		return false;
+	}
+
+	DataBuffer.RebuildState = ERuntimeLandscapeRebuildState::RLRS_BuildGrassTrees;
+	while (Slot.GrassTreeRunners.Num() < DataBuffer.GrassTrees.Num())
+	{
+		Slot.GrassTreeRunners.Add(new FBuildGrassTreeWorker(this, &Slot));
+	}
+
+	Slot.ActiveRunners = DataBuffer.GrassTrees.Num();
+	for (int32 i = 0; i < DataBuffer.GrassTrees.Num(); ++i)
+	{
+		Slot.GrassTreeRunners[i]->QueueWork(i);
+	}
+
+	return true;
+}
+
+void URuntimeLandscapeRebuildManager::FinishRebuild(FRuntimeLandscapeRebuildSlot& Slot)
+{
+	URuntimeLandscapeComponent* Component = Slot.Component;
+	Component->FinishRebuild(Slot.DataBuffer);
+	Component->UpdateMemoryStats();
+	Component->bIsRebuilding = false;
+	Landscape->GetEditTracker().FinishEdits(Slot.DataBuffer.EditIds);
+	Slot.DataBuffer.EditIds.Reset();
+	Slot.DataBuffer.GrassRules.Reset();
+	Slot.Component = nullptr;
+	FRuntimeEditableLandscapeModule::TrackRebuilds(0, -1);
+	Slot.DataBuffer.RebuildState = ERuntimeLandscapeRebuildState::RLRS_None;
+	++FinishedRebuildAmount;
+
+	// the component changed while it was rebuilding, so it is rebuilt again with the edits it collected meanwhile
+	if (Component->bIsRebuildRequested)
+	{
+		Component->bIsRebuildRequested = false;
+		if (Component->bIsOnlyGrassRebuildRequested)
+		{
+			Component->RebuildGrass();
+		}
+		else
+		{
+			Component->Rebuild();
+		}
+	}
+
+	// the component was streamed out meanwhile, so the collected edits are not rebuilt
+	if (!Component->bIsStale)
+	{
+		Landscape->GetEditTracker().FinishEdits(Component->PendingEditIds);
+		Component->PendingEditIds.Reset();
+	}
+
+	if (bIsBulkBuilding)
+	{
+		++BulkBuildFinishedAmount;
+		Landscape->OnBuildProgress.Broadcast(BulkBuildFinishedAmount, BulkBuildComponentAmount);
+	}
+}
+
+void URuntimeLandscapeRebuildManager::CancelRebuild(FRuntimeLandscapeRebuildSlot& Slot)
+{
+	// every runner of the slot is abandoned, but the rebuild is only counted once
+	if (URuntimeLandscapeComponent* Component = Slot.Component)
+	{
+		FRuntimeEditableLandscapeModule::TrackRebuilds(0, -1);
+		Landscape->GetEditTracker().FinishEdits(Slot.DataBuffer.EditIds);
+		Component->bIsRebuilding = false;
+		Component->bIsRebuildRequested = false;
+		Component->bIsStale = false;
+		Component->bOnlyGrassIsStale = false;
+	}
+
+	Slot.DataBuffer.EditIds.Reset();
+	Slot.DataBuffer.GrassRules.Reset();
+	Slot.Component = nullptr;
+	Slot.ActiveRunners = 0;
+	Slot.DataBuffer.RebuildState = ERuntimeLandscapeRebuildState::RLRS_None;
+}
+
+bool URuntimeLandscapeRebuildManager::IsRebuilding() const
+{
+	if (QueuedRebuildAmount > 0)
+	{
+		return true;
+	}
+
+	for (const TUniquePtr<FRuntimeLandscapeRebuildSlot>& Slot : Slots)
+	{
+		if (Slot->Component)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void URuntimeLandscapeRebuildManager::RebuildNextInQueue()
+{
+	bool bIsRebuilding = false;
+	for (int32 SlotIndex = 0; SlotIndex < MaxConcurrentRebuilds; ++SlotIndex)
+	{
+		if (!Slots.IsValidIndex(SlotIndex))
+		{
+			Initialize();
+			InitializeSlot(*Slots.Add_GetRef(MakeUnique<FRuntimeLandscapeRebuildSlot>()));
+		}
+
+		FRuntimeLandscapeRebuildSlot& Slot = *Slots[SlotIndex];
+		while (!Slot.Component && RebuildQueue.Dequeue(Slot.Component))
+		{
+			--QueuedRebuildAmount;
+			const bool bIsStarted = StartRebuild(Slot);
+			FRuntimeEditableLandscapeModule::TrackRebuilds(-1, bIsStarted ? 1 : 0);
+		}
+
+		bIsRebuilding |= Slot.Component != nullptr;
+	}
+
+	if (bIsRebuilding)
+	{
+		SetComponentTickEnabled(true);
+		return;
+	}
+
+	SetComponentTickEnabled(false);
+	if (bIsBulkBuilding && !bIsCollectingBulkBuild)
+	{
+		UE_LOG(RuntimeEditableLandscape, Display, TEXT("Built %i components of %s in %.2f seconds"),
+		       BulkBuildFinishedAmount, *GetOwner()->GetName(), FPlatformTime::Seconds() - BulkBuildStartTime);
+
+		bIsBulkBuilding = false;
+		MaxConcurrentRebuilds = 1;
+		SetComponentTickInterval(DefaultTickInterval);
+	}
+}
+
+void URuntimeLandscapeRebuildManager::UpdateMemoryStats()
+{
+	int64 BufferMemory = 0;
+	for (const TUniquePtr<FRuntimeLandscapeRebuildSlot>& Slot : Slots)
+	{
+		BufferMemory += Slot->DataBuffer.GetAllocatedSize();
+		for (const FGenerateAdditionalVertexDataWorker* Runner : Slot->AdditionalDataRunners)
+		{
+			BufferMemory += Runner->GrassData.GetAllocatedSize();
+		}
+	}
+
+	FRuntimeEditableLandscapeModule::TrackMemory(ERuntimeLandscapeMemory::RebuildBuffers,
+	                                             BufferMemory - TrackedBufferMemory);
+	TrackedBufferMemory = BufferMemory;
+}
+
 void URuntimeLandscapeRebuildManager::TickComponent(float DeltaTime, enum ELevelTick TickType,
                                                     FActorComponentTickFunction* ThisTickFunction)
 {
-	if (ActiveRunners < 1)
+	SCOPE_CYCLE_COUNTER(STAT_UpdateRuntimeLandscape);
+	int32 RemainingCommits = Landscape->MaxRebuildCommitsPerFrame;
+	// finishing a rebuild can queue new rebuilds, so the slots are iterated by index
+	for (int32 SlotIndex = 0; SlotIndex < Slots.Num(); ++SlotIndex)
 	{
-		switch (DataBuffer.RebuildState)
+		FRuntimeLandscapeRebuildSlot* Slot = Slots[SlotIndex].Get();
+		if (!Slot->Component || Slot->ActiveRunners > 0)
+		{
+			continue;
+		}
+
+		switch (Slot->DataBuffer.RebuildState)
 		{
 		case RLRS_BuildVertices:
-			StartGenerateAdditionalData();
-			break;
+			if (!Slot->DataBuffer.bIsRestoredFromCache)
+			{
+				StartGenerateAdditionalData(*Slot);
+				break;
+			}
+
+			// the additional data was restored with the vertices, so the rebuild continues with the grass trees
+			Slot->DataBuffer.bReprojectGrass = false;
+			Slot->DataBuffer.GrassWeightsVersion = Slot->Component->GroundTypeWeightsVersion;
+			Slot->DataBuffer.RebuildState = ERuntimeLandscapeRebuildState::RLRS_BuildAdditionalData;
+			[[fallthrough]];
 		case RLRS_BuildAdditionalData:
-			CurrentComponent->FinishRebuild(DataBuffer);
-			RebuildNextInQueue();
+			if (!Slot->DataBuffer.bIsRestoredFromCache)
+			{
+				CollectGrassData(*Slot);
+			}
+
+			if (StartBuildGrassTrees(*Slot))
+			{
+				break;
+			}
+			[[fallthrough]];
+		case RLRS_BuildGrassTrees:
+			Slot->DataBuffer.RebuildState = ERuntimeLandscapeRebuildState::RLRS_Commit;
+			[[fallthrough]];
+		case RLRS_Commit:
+			// applying the data to the component is expensive, so it is spread across frames
+			if (RemainingCommits > 0)
+			{
+				--RemainingCommits;
+				FinishRebuild(*Slot);
+			}
 			break;
 		default:
 			checkNoEntry();
 		}
 	}
+
+	RebuildNextInQueue();
+	UpdateMemoryStats();
+}
+
+void URuntimeLandscapeRebuildManager::OnComponentDestroyed(bool bDestroyingHierarchy)
+{
+	// the runners point into the slots, so queued runners are abandoned and running ones are waited for
+	if (ThreadPool)
+	{
+		ThreadPool->Destroy();
+		delete ThreadPool;
+		ThreadPool = nullptr;
+	}
+
+	for (const TUniquePtr<FRuntimeLandscapeRebuildSlot>& Slot : Slots)
+	{
+		CancelRebuild(*Slot);
+	}
+
+	Slots.Empty();
+	FRuntimeEditableLandscapeModule::TrackRebuilds(-QueuedRebuildAmount, 0);
+	FRuntimeEditableLandscapeModule::TrackMemory(ERuntimeLandscapeMemory::RebuildBuffers, -TrackedBufferMemory);
+	QueuedRebuildAmount = 0;
+	TrackedBufferMemory = 0;
+
+	Super::OnComponentDestroyed(bDestroyingHierarchy);
 }
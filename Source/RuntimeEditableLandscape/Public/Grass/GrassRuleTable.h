@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FGrassTypeSettings;
+struct FHeightBasedLandscapeData;
+class ULandscapeGrassType;
+class ULandscapeGroundTypeData;
+
+/**
+ * A compiled grass selection rule
+ */
+struct FGrassRule
+{
+	/** The grass to place, nullptr if the rule explicitly places no grass */
+	const ULandscapeGrassType* GrassType = nullptr;
+	/** The cosine of the max slope angle, grass is only placed where the normal Z is at least this value */
+	float MinNormalZ = -1.0f;
+};
+
+/**
+ * Ground type and height based grass settings of a landscape, compiled into flat arrays
+ * so grass can be selected per vertex without copies or trigonometry
+ */
+class RUNTIMEEDITABLELANDSCAPE_API FGrassRuleTable
+{
+public:
+	/** Ground types need more than this weight (0.2) to select their grass */
+	static constexpr uint8 MinGroundTypeWeight = 51;
+
+	/**
+	 * Compile the rules
+	 * @param GroundTypesByPlane	The ground types in the order of their weight planes
+	 * @param HeightBasedData		The height based grass, later entries take priority
+	 */
+	void Build(TConstArrayView<const ULandscapeGroundTypeData*> GroundTypesByPlane,
+	           TConstArrayView<FHeightBasedLandscapeData> HeightBasedData);
+
+	/**
+	 * Select the rule of a vertex
+	 * @param DominantPlane		The dominant ground type plane of the vertex
+	 * @param DominantWeight	The weight of the dominant ground type
+	 * @param Height			The world height of the vertex
+	 * @return INDEX_NONE if no rule applies
+	 */
+	FORCEINLINE int32 SelectRule(uint8 DominantPlane, uint8 DominantWeight, float Height) const
+	{
+		if (DominantPlane < PlaneAmount && DominantWeight > MinGroundTypeWeight)
+		{
+			return DominantPlane;
+		}
+
+		for (const FHeightBand& HeightBand : HeightBands)
+		{
+			if (HeightBand.MinHeight < Height && HeightBand.MaxHeight > Height)
+			{
+				return HeightBand.Rule;
+			}
+		}
+
+		return INDEX_NONE;
+	}
+
+	/** Check if the rule places grass on a surface with the specified normal */
+	FORCEINLINE bool IsSlopeAllowed(int32 Rule, const FVector& Normal) const
+	{
+		return Normal.Z >= Rules[Rule].MinNormalZ;
+	}
+
+	FORCEINLINE const FGrassRule& GetRule(int32 Rule) const { return Rules[Rule]; }
+	FORCEINLINE int32 GetRuleAmount() const { return Rules.Num(); }
+	/** Whether the rule was selected through a ground type (weighted) or a height band (full weight) */
+	FORCEINLINE bool IsGroundTypeRule(int32 Rule) const { return Rule < PlaneAmount; }
+	/**
+	 * Hash the rules and the settings of their grass types
+	 * The hash is the same across sessions, so it can be stored
+	 */
+	uint32 CalculateHash() const;
+
+private:
+	struct FHeightBand
+	{
+		float MinHeight;
+		float MaxHeight;
+		int32 Rule;
+	};
+
+	/** One rule per ground type plane followed by one rule per height band */
+	TArray<FGrassRule> Rules;
+	/** Height bands in priority order */
+	TArray<FHeightBand> HeightBands;
+	int32 PlaneAmount = 0;
+
+	static FGrassRule CompileRule(const FGrassTypeSettings& Settings);
+};
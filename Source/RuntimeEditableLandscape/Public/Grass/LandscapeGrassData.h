@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LandscapeGrassType.h"
+
+/**
+ * Grass instances of a single mesh, sorted by vertex
+ */
+struct FLandscapeGrassMeshBuffer
+{
+	/** The variety that created the instances, owned by the grass type */
+	const FGrassVariety* GrassVariety = nullptr;
+	TArray<FTransform> InstanceTransformsRelative;
+	/** The vertex of every instance */
+	TArray<int32> InstanceVertices;
+};
+
+/**
+ * Grass instances of all meshes
+ * Buffers are reset instead of freed, so they can be reused without allocating
+ */
+struct FLandscapeGrassData
+{
+	TArray<FLandscapeGrassMeshBuffer> MeshBuffers;
+
+	FLandscapeGrassMeshBuffer& FindOrAddMeshBuffer(const FGrassVariety& Variety)
+	{
+		for (FLandscapeGrassMeshBuffer& MeshBuffer : MeshBuffers)
+		{
+			if (MeshBuffer.GrassVariety->GrassMesh == Variety.GrassMesh)
+			{
+				return MeshBuffer;
+			}
+		}
+
+		FLandscapeGrassMeshBuffer& Result = MeshBuffers.AddDefaulted_GetRef();
+		Result.GrassVariety = &Variety;
+		return Result;
+	}
+
+	int32 GetInstanceAmount() const
+	{
+		int32 Result = 0;
+		for (const FLandscapeGrassMeshBuffer& MeshBuffer : MeshBuffers)
+		{
+			Result += MeshBuffer.InstanceTransformsRelative.Num();
+		}
+
+		return Result;
+	}
+
+	SIZE_T GetAllocatedSize() const
+	{
+		SIZE_T Result = MeshBuffers.GetAllocatedSize();
+		for (const FLandscapeGrassMeshBuffer& MeshBuffer : MeshBuffers)
+		{
+			Result += MeshBuffer.InstanceTransformsRelative.GetAllocatedSize()
+				+ MeshBuffer.InstanceVertices.GetAllocatedSize();
+		}
+
+		return Result;
+	}
+
+	void Reset()
+	{
+		for (FLandscapeGrassMeshBuffer& MeshBuffer : MeshBuffers)
+		{
+			MeshBuffer.InstanceTransformsRelative.Reset();
+			MeshBuffer.InstanceVertices.Reset();
+		}
+	}
+
+	/** Append the instances of the other data, the other data has to contain higher vertices only */
+	void Append(const FLandscapeGrassData& Other)
+	{
+		for (const FLandscapeGrassMeshBuffer& OtherBuffer : Other.MeshBuffers)
+		{
+			if (OtherBuffer.InstanceTransformsRelative.IsEmpty() == false)
+			{
+				FLandscapeGrassMeshBuffer& MeshBuffer = FindOrAddMeshBuffer(*OtherBuffer.GrassVariety);
+				MeshBuffer.InstanceTransformsRelative.Append(OtherBuffer.InstanceTransformsRelative);
+				MeshBuffer.InstanceVertices.Append(OtherBuffer.InstanceVertices);
+			}
+		}
+	}
+};
@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RuntimeLandscapeGrassMesh.generated.h"
+
+struct FGrassVariety;
+struct FLandscapeGrassTree;
+class UHierarchicalInstancedStaticMeshComponent;
+
+USTRUCT()
+/**
+ * A grass mesh that is kept across rebuilds
+ * Remembers which vertex every instance belongs to, so rebuilds only touch the instances of changed vertices
+ */
+struct RUNTIMEEDITABLELANDSCAPE_API FRuntimeLandscapeGrassMesh
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<UHierarchicalInstancedStaticMeshComponent> InstancedMesh;
+
+	/**
+	 * Update the instances to match the provided instances
+	 * Only instances of vertices that changed are updated, freed instances are parked and reused later
+	 * @param Transforms		The relative transforms of all instances of the component
+	 * @param TransformVertices	The vertex of every transform, has to be sorted
+	 * @param VertexAmount		The amount of vertices of the component
+	 * @return The amount of instances that were added, moved or removed
+	 */
+	int32 UpdateInstances(TConstArrayView<FTransform> Transforms, TConstArrayView<int32> TransformVertices,
+	                      int32 VertexAmount);
+	/**
+	 * Update the instances of the vertices inside an area, the instances of all other vertices are kept
+	 * @param Transforms		The relative transforms of all instances inside the area
+	 * @param TransformVertices	The vertex of every transform, has to be sorted
+	 * @param RowLength			The amount of vertices in a row
+	 * @param Area				The updated vertex coordinates, the max is exclusive
+	 * @return The amount of instances that were added, moved or removed
+	 */
+	int32 UpdateInstancesInArea(TConstArrayView<FTransform> Transforms, TConstArrayView<int32> TransformVertices,
+	                            int32 RowLength, const FIntRect& Area);
+	/**
+	 * Check if all instances will be replaced when updating to the specified amount of instances
+	 * In that case the cluster tree can be built in advance on a worker thread
+	 */
+	bool NeedsFullRebuild(int32 NewInstanceAmount) const;
+	/** Replace all instances with the instances of a tree that was built in advance, the tree data is moved */
+	void AcceptPrebuiltTree(FLandscapeGrassTree& GrassTree);
+	/** Remove all instances but keep the instanced mesh */
+	void ClearInstances();
+	/** Apply the settings of the grass variety to the instanced mesh */
+	void ApplyVarietySettings(const FGrassVariety& Variety) const;
+	/**
+	 * Find the grass mesh of the variety or create it
+	 * @param GrassMeshes	The pooled grass meshes
+	 * @param Variety		The grass variety
+	 * @param AttachParent	The component a created instanced mesh is attached to
+	 * @return The index of the grass mesh
+	 */
+	static int32 FindOrAdd(TArray<FRuntimeLandscapeGrassMesh>& GrassMeshes, const FGrassVariety& Variety,
+	                       USceneComponent* AttachParent);
+	/** Get the amount of instances that are currently in use */
+	FORCEINLINE int32 GetUsedInstanceAmount() const { return SlotVertices.Num() - FreeSlots.Num(); }
+
+private:
+	/** The vertex every instance slot belongs to, INDEX_NONE for free slots */
+	TArray<int32> SlotVertices;
+	/** The relative transform of every instance slot */
+	TArray<FTransform> SlotTransforms;
+	/** Slots that are not used and are hidden, they are reused before new instances are added */
+	TArray<int32> FreeSlots;
+
+	/** Replace all instances, used for the initial fill and to get rid of too many free slots */
+	void ResetInstances(TConstArrayView<FTransform> Transforms, TConstArrayView<int32> TransformVertices);
+	/**
+	 * Send the changed slots to the instanced mesh
+	 * Contiguous slots are updated in a single batch
+	 */
+	void FlushSlotUpdates(TArray<int32>& ChangedSlots) const;
+};
+
+USTRUCT()
+/**
+ * Grass meshes of a square area of the landscape that is independent of component boundaries
+ * Instances are identified by the landscape vertex they belong to, relative to the cluster
+ */
+struct RUNTIMEEDITABLELANDSCAPE_API FRuntimeLandscapeGrassCluster
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FRuntimeLandscapeGrassMesh> GrassMeshes;
+};
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum ELayerShape : uint8;
+
+/**
+ * Rasterizes ground type brushes on the CPU
+ * Replaces drawing brush materials to a render target, so painting works without a renderer (i.e. on dedicated servers)
+ */
+struct RUNTIMEEDITABLELANDSCAPE_API FGroundTypeBrushRasterizer
+{
+	/**
+	 * @param InShape			The shape of the brush (box or round)
+	 * @param BrushTransform	The world transform of the brush, only the yaw is used for rotation
+	 * @param InExtent			The half size of the brush in world units
+	 * @param InFalloff			The distance from the brush edge (inwards) in which the brush strength fades out
+	 */
+	FGroundTypeBrushRasterizer(ELayerShape InShape, const FTransform& BrushTransform, const FVector2D& InExtent,
+	                           float InFalloff);
+
+	/**
+	 * Get the vertices affected by the brush
+	 * @param GridOrigin		The world location of the first vertex
+	 * @param VertexDistance	The distance between two vertices
+	 * @param GridSize			The amount of vertices in X and Y direction
+	 * @return The affected vertex coordinates (Max is exclusive), clamped to the grid
+	 */
+	FIntRect GetAffectedVertexRect(const FVector2D& GridOrigin, float VertexDistance, const FIntPoint& GridSize) const;
+
+	/**
+	 * Get the brush strength at the specified world location
+	 * @return 1 inside the brush, 0 outside the brush and a linear fade inside the falloff area
+	 */
+	float GetStrength(const FVector2D& WorldLocation) const;
+
+private:
+	ELayerShape Shape;
+	FVector2D Center;
+	FVector2D Extent;
+	/** Sine and cosine of the brush yaw, cached to avoid trigonometry per vertex */
+	float YawSin;
+	float YawCos;
+	float Falloff;
+};
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GroundTypeWeightTile.generated.h"
+
+/** Marks vertices without a dominant ground type */
+#define GROUND_TYPE_PLANE_NONE MAX_uint8
+/** Plane indices are stored as uint8, one value is reserved for GROUND_TYPE_PLANE_NONE */
+#define MAX_GROUND_TYPE_PLANES (MAX_uint8 - 1)
+
+/**
+ * Location of a ground type in the weight storage
+ */
+struct FGroundTypeLayerIndex
+{
+	/** The weight plane of the ground type in each component tile */
+	int32 Plane = INDEX_NONE;
+	/** The layer set (render target) the ground type is mirrored to, INDEX_NONE if it is CPU only */
+	int32 LayerSet = INDEX_NONE;
+	/** The color channel in the layer set render target (0 = R, 1 = G, 2 = B, 3 = A) */
+	int32 Channel = INDEX_NONE;
+};
+
+USTRUCT()
+/**
+ * Dense weights of a single ground type inside a single component
+ */
+struct FGroundTypeWeightPlane
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	/** One weight per component vertex, empty if the ground type has no weight inside the component */
+	TArray<uint8> Weights;
+};
+
+USTRUCT()
+/**
+ * Stores the ground type weights of a single landscape component
+ * Weight planes are only allocated for ground types that have non-zero weights inside the component
+ */
+struct RUNTIMEEDITABLELANDSCAPE_API FGroundTypeWeightTile
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	/** Weight planes, indexed by FGroundTypeLayerIndex::Plane */
+	TArray<FGroundTypeWeightPlane> Planes;
+	UPROPERTY()
+	/**
+	 * The plane with the highest weight for every vertex, GROUND_TYPE_PLANE_NONE if no weight is set
+	 * Empty if no plane is allocated
+	 */
+	TArray<uint8> DominantPlanes;
+
+	FORCEINLINE bool IsPlaneAllocated(int32 Plane) const
+	{
+		return Planes.IsValidIndex(Plane) && Planes[Plane].Weights.IsEmpty() == false;
+	}
+
+	FORCEINLINE uint8 GetWeight(int32 Plane, int32 VertexIndex) const
+	{
+		return IsPlaneAllocated(Plane) ? Planes[Plane].Weights[VertexIndex] : 0;
+	}
+
+	/**
+	 * Get the weights of the specified plane, allocating zeroed weights if required
+	 * @param Plane			The plane index
+	 * @param VertexAmount	The amount of vertices in the component
+	 */
+	TArray<uint8>& GetOrAllocatePlane(int32 Plane, int32 VertexAmount);
+
+	FORCEINLINE uint8 GetDominantPlane(int32 VertexIndex) const
+	{
+		return DominantPlanes.IsEmpty() ? GROUND_TYPE_PLANE_NONE : DominantPlanes[VertexIndex];
+	}
+
+	/** Free all planes that only contain zero weights */
+	void ReleaseEmptyPlanes();
+	/** Update the dominant planes, call after changing weights */
+	void UpdateDominantPlanes(int32 VertexAmount);
+	/** Get the amount of allocated bytes */
+	SIZE_T GetAllocatedSize() const;
+};
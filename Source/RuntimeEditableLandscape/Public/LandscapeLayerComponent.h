@@ -53,6 +53,14 @@ public:
 	FORCEINLINE const FVector& GetExtent() const { return Extent; }
 	FORCEINLINE const FBox2D& GetBoundingBox() const { return BoundingBox; }
 	FORCEINLINE const TSet<const ULandscapeLayerDataBase*>& GetLayerData() const { return Layers; }
+	/** Use a box of the extent as shape, must be called before the component is registered */
+	FORCEINLINE void SetBoxExtent(const FVector& NewExtent)
+	{
+		Shape = ELayerShape::HS_Box;
+		Extent = NewExtent;
+	}
+	/** Add layer data that is applied with the layer, must be called before the component is registered */
+	FORCEINLINE void AddLayerData(const ULandscapeLayerDataBase* LayerData) { Layers.Add(LayerData); }
 
 	void ApplyToLandscape();
 	bool IsAffectedByLayer(FVector2D Location) const;
@@ -90,6 +98,8 @@ protected:
 	FBox2D InnerBox = FBox2D();
 	float BoundsSmoothingOffset = 0.0f;
 	float InnerSmoothingOffset = 0.0f;
+	/** Whether the affected landscapes are resolved from the bounding box, because none were specified */
+	bool bResolveAffectedLandscapes = false;
 
 	/**
 	 * Try to calculate the smoothing distance
@@ -106,6 +116,8 @@ protected:
 	                         ETeleportType Teleport);
 	void RemoveFromLandscapes();
 	void UpdateShape();
+	/** Replace the affected landscapes with the registered landscapes that overlap the bounding box */
+	void ResolveAffectedLandscapes();
 
 	UFUNCTION()
 	void HandleOwnerDestroyed(AActor* DestroyedActor) { DestroyComponent(); }
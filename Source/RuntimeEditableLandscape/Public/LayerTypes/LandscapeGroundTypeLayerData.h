@@ -6,8 +6,6 @@
 #include "LandscapeLayerDataBase.h"
 #include "LandscapeGroundTypeLayerData.generated.h"
 
-#define MATERIAL_PARAMETER_GROUND_TYPE_LAYER_COLOR FName("GroundTypeLayerColor")
-
 class ULandscapeGroundTypeData;
 /**
  * Layer data that applies a landscape paint layer
@@ -17,6 +15,10 @@ class RUNTIMEEDITABLELANDSCAPE_API ULandscapeGroundTypeLayerData : public ULands
 {
 	GENERATED_BODY()
 
+public:
+	FORCEINLINE void SetGroundType(const ULandscapeGroundTypeData* NewGroundType) { GroundType = NewGroundType; }
+
+private:
 	UPROPERTY(EditAnywhere)
 	TObjectPtr<const ULandscapeGroundTypeData> GroundType;
 
@@ -14,6 +14,9 @@ class RUNTIMEEDITABLELANDSCAPE_API ULandscapeHeightLayerData : public ULandscape
 {
 	GENERATED_BODY()
 
+public:
+	FORCEINLINE void SetHeightValue(float NewHeightValue) { HeightValue = NewHeightValue; }
+
 protected:
 	UPROPERTY(EditAnywhere)
 	float HeightValue;
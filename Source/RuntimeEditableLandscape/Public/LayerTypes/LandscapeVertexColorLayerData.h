@@ -14,6 +14,9 @@ class RUNTIMEEDITABLELANDSCAPE_API ULandscapeVertexColorLayerData : public ULand
 {
 	GENERATED_BODY()
 
+public:
+	FORCEINLINE void SetVertexColor(const FColor& NewVertexColor) { VertexColor = NewVertexColor; }
+
 protected:
 	UPROPERTY(EditAnywhere)
 	FColor VertexColor;
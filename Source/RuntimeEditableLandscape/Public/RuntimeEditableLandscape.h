@@ -3,13 +3,76 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
 #include "Modules/ModuleManager.h"
+#include "ProfilingDebugging/CsvProfiler.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(RuntimeEditableLandscape, Display, Display);
 
 DECLARE_STATS_GROUP(TEXT("Stats for the runtime editable landscape"), STATGROUP_RuntimeLandscape, STATCAT_Advanced)
 DECLARE_CYCLE_STAT(TEXT("Update runtime landscape"), STAT_UpdateRuntimeLandscape, STATGROUP_RuntimeLandscape)
 DECLARE_CYCLE_STAT(TEXT("Add landscape layer"), STAT_AddLandscapeLayer, STATGROUP_RuntimeLandscape)
+DECLARE_CYCLE_STAT(TEXT("Apply layers"), STAT_RuntimeLandscapeApplyLayers, STATGROUP_RuntimeLandscape)
+DECLARE_CYCLE_STAT(TEXT("Build vertices"), STAT_RuntimeLandscapeBuildVertices, STATGROUP_RuntimeLandscape)
+DECLARE_CYCLE_STAT(TEXT("Calculate tangents"), STAT_RuntimeLandscapeTangents, STATGROUP_RuntimeLandscape)
+DECLARE_CYCLE_STAT(TEXT("Generate grass"), STAT_RuntimeLandscapeGenerateGrass, STATGROUP_RuntimeLandscape)
+DECLARE_CYCLE_STAT(TEXT("Build grass trees"), STAT_RuntimeLandscapeBuildGrassTrees, STATGROUP_RuntimeLandscape)
+DECLARE_CYCLE_STAT(TEXT("Update grass"), STAT_RuntimeLandscapeUpdateGrass, STATGROUP_RuntimeLandscape)
+DECLARE_CYCLE_STAT(TEXT("Generate triangles"), STAT_RuntimeLandscapeGenerateTriangles, STATGROUP_RuntimeLandscape)
+DECLARE_CYCLE_STAT(TEXT("Commit mesh and collision"), STAT_RuntimeLandscapeCommitMesh, STATGROUP_RuntimeLandscape)
+DECLARE_CYCLE_STAT(TEXT("Restore from mesh cache"), STAT_RuntimeLandscapeMeshCache, STATGROUP_RuntimeLandscape)
+DECLARE_CYCLE_STAT(TEXT("Store in mesh cache"), STAT_RuntimeLandscapeMeshCacheStore, STATGROUP_RuntimeLandscape)
+DECLARE_CYCLE_STAT(TEXT("Update foliage"), STAT_RuntimeLandscapeFoliage, STATGROUP_RuntimeLandscape)
+DECLARE_CYCLE_STAT(TEXT("Update navigation"), STAT_RuntimeLandscapeNavigation, STATGROUP_RuntimeLandscape)
+DECLARE_CYCLE_STAT(TEXT("Export navigation geometry"), STAT_RuntimeLandscapeNavigationExport, STATGROUP_RuntimeLandscape)
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Queued rebuilds"), STAT_RuntimeLandscapeQueuedRebuilds, STATGROUP_RuntimeLandscape)
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Rebuilds in flight"), STAT_RuntimeLandscapeActiveRebuilds, STATGROUP_RuntimeLandscape)
+DECLARE_DWORD_COUNTER_STAT(TEXT("Generated grass instances"), STAT_RuntimeLandscapeGeneratedGrassInstances, STATGROUP_RuntimeLandscape)
+DECLARE_MEMORY_STAT(TEXT("Heights"), STAT_RuntimeLandscapeHeightsMemory, STATGROUP_RuntimeLandscape)
+DECLARE_MEMORY_STAT(TEXT("Ground type weights"), STAT_RuntimeLandscapeGroundTypeWeightsMemory, STATGROUP_RuntimeLandscape)
+DECLARE_MEMORY_STAT(TEXT("Grass"), STAT_RuntimeLandscapeGrassMemory, STATGROUP_RuntimeLandscape)
+DECLARE_MEMORY_STAT(TEXT("Rebuild buffers"), STAT_RuntimeLandscapeRebuildBuffersMemory, STATGROUP_RuntimeLandscape)
+
+CSV_DECLARE_CATEGORY_EXTERN(RuntimeLandscape);
+
+/**
+ * Time a stage with the cycle stat STAT_RuntimeLandscape<Stage>, the csv stat <Stage> of the RuntimeLandscape category
+ * and the stage timings of the module
+ */
+#define RUNTIME_LANDSCAPE_SCOPE_STAT(Stage) \
+	SCOPE_CYCLE_COUNTER(STAT_RuntimeLandscape##Stage); \
+	CSV_SCOPED_TIMING_STAT(RuntimeLandscape, Stage); \
+	const FRuntimeLandscapeStageTimer PREPROCESSOR_JOIN(RuntimeLandscapeStageTimer, __LINE__)( \
+		ERuntimeLandscapeStage::Stage)
+
+/** The timed stages, named like their stats */
+enum class ERuntimeLandscapeStage : uint8
+{
+	ApplyLayers,
+	BuildVertices,
+	Tangents,
+	GenerateGrass,
+	BuildGrassTrees,
+	UpdateGrass,
+	GenerateTriangles,
+	CommitMesh,
+	MeshCache,
+	MeshCacheStore,
+	Foliage,
+	Navigation,
+	NavigationExport,
+	Num
+};
+
+/** The buffer types whose memory is tracked */
+enum class ERuntimeLandscapeMemory : uint8
+{
+	Heights,
+	GroundTypeWeights,
+	Grass,
+	RebuildBuffers,
+	Num
+};
 
 class FRuntimeEditableLandscapeModule : public IModuleInterface
 {
@@ -18,4 +81,69 @@ public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+	/**
+	 * Add to the tracked memory of a buffer type
+	 * Thread safe, the totals are emitted as memory stats and as csv stats (in MB) once per frame
+	 */
+	static void TrackMemory(ERuntimeLandscapeMemory Type, int64 Delta);
+	/** Add to the queued and running rebuilds of all landscapes, emitted like the tracked memory */
+	static void TrackRebuilds(int32 QueuedDelta, int32 InFlightDelta);
+	FORCEINLINE static int64 GetTrackedMemory(ERuntimeLandscapeMemory Type)
+	{
+		return TrackedMemory[static_cast<int32>(Type)].load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Accumulate the time of every stage until the timings are disabled again
+	 * Independent of the stats system, so the timings are available in any build configuration (i.e. for benchmarks)
+	 */
+	static void SetStageTimingsEnabled(bool bEnabled);
+	FORCEINLINE static bool AreStageTimingsEnabled() { return bStageTimingsEnabled.load(std::memory_order_relaxed); }
+	static void ResetStageTimings();
+	static void AddStageTime(ERuntimeLandscapeStage Stage, uint64 Cycles);
+	/**
+	 * Get the accumulated time of a stage
+	 * @param Stage			The stage
+	 * @param OutSeconds	The time of all threads in seconds
+	 * @param OutCalls		How often the stage was run
+	 */
+	static void GetStageTiming(ERuntimeLandscapeStage Stage, double& OutSeconds, int64& OutCalls);
+	static const TCHAR* GetStageName(ERuntimeLandscapeStage Stage);
+
+private:
+	static TStaticArray<std::atomic<int64>, static_cast<int32>(ERuntimeLandscapeMemory::Num)> TrackedMemory;
+	static std::atomic<bool> bStageTimingsEnabled;
+	static TStaticArray<std::atomic<uint64>, static_cast<int32>(ERuntimeLandscapeStage::Num)> StageCycles;
+	static TStaticArray<std::atomic<int64>, static_cast<int32>(ERuntimeLandscapeStage::Num)> StageCalls;
+	static std::atomic<int32> QueuedRebuilds;
+	static std::atomic<int32> RebuildsInFlight;
+
+	FDelegateHandle EndFrameHandle;
+
+	/** Write the tracked counters to the csv profiler */
+	static void RecordCsvStats();
+};
+
+/** Adds the time of its scope to the stage timings of the module, if they are enabled */
+class FRuntimeLandscapeStageTimer
+{
+public:
+	explicit FRuntimeLandscapeStageTimer(ERuntimeLandscapeStage InStage)
+		: StartCycles(FRuntimeEditableLandscapeModule::AreStageTimingsEnabled() ? FPlatformTime::Cycles64() : 0),
+		  Stage(InStage)
+	{
+	}
+
+	~FRuntimeLandscapeStageTimer()
+	{
+		if (StartCycles != 0)
+		{
+			FRuntimeEditableLandscapeModule::AddStageTime(Stage, FPlatformTime::Cycles64() - StartCycles);
+		}
+	}
+
+private:
+	uint64 StartCycles;
+	ERuntimeLandscapeStage Stage;
 };
@@ -3,8 +3,13 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "GroundTypeWeightTile.h"
 #include "LandscapeGroundTypeData.h"
+#include "RuntimeLandscapeEditTrace.h"
+#include "RuntimeLandscapeHeightTiles.h"
 #include "GameFramework/Actor.h"
+#include "Grass/GrassRuleTable.h"
+#include "Grass/RuntimeLandscapeGrassMesh.h"
 #include "RuntimeLandscape.generated.h"
 
 class URuntimeLandscapeRebuildManager;
@@ -16,12 +21,13 @@ class ALandscape;
 
 class UProceduralMeshComponent;
 
-USTRUCT(Blueprintable)
+USTRUCT()
+/** A material brush of a ground type shape, brushes are rasterized on the CPU instead */
 struct FGroundTypeBrushData
 {
 	GENERATED_BODY()
 
-	UPROPERTY(EditAnywhere)
+	UPROPERTY()
 	TObjectPtr<UMaterialInterface> BrushMaterial;
 	UPROPERTY()
 	TObjectPtr<UMaterialInstanceDynamic> BrushMaterialInstance;
@@ -29,7 +35,7 @@ struct FGroundTypeBrushData
 
 USTRUCT(Blueprintable)
 /**
- * Caches data for up to 4 landscape ground layers
+ * Mirrors the weights of up to 4 landscape ground layers to a render target, so they can be used in materials
  */
 struct FRuntimeLandscapeGroundTypeLayerSet
 {
@@ -46,39 +52,41 @@ struct FRuntimeLandscapeGroundTypeLayerSet
 	TObjectPtr<UTextureRenderTarget2D> RenderTarget;
 	UPROPERTY(EditAnywhere, meta = (EditFixedSize))
 	TArray<const ULandscapeGroundTypeData*> GroundTypes;
-	UPROPERTY()
-	/**
-	 * The weights for the layers
-	 * each layer is stored in a separate color channel 
-	 */
-	TArray<FColor> VertexLayerWeights;
 
 	TArray<FName> GetLayerNames() const;
 
-	FLinearColor GetColorChannelForLayer(const ULandscapeGroundTypeData* GroundType) const
+	/** Get the weight of the specified channel (0 = R, 1 = G, 2 = B, 3 = A) */
+	static FORCEINLINE uint8& GetChannelValue(FColor& Color, int32 Channel)
 	{
-		int32 LayerIndex = GroundTypes.IndexOfByKey(GroundType);
-		if (ensure(LayerIndex != INDEX_NONE))
+		switch (Channel)
 		{
-			switch (LayerIndex)
-			{
-			case 0:
-				return FLinearColor(1, 0, 0, 0);
-			case 1:
-				return FLinearColor(0, 1, 0, 0);
-			case 2:
-				return FLinearColor(0, 0, 1, 0);
-			case 3:
-				return FLinearColor(0, 0, 0, 1);
-			default:
-				checkNoEntry();
-			}
+		case 0:
+			return Color.R;
+		case 1:
+			return Color.G;
+		case 2:
+			return Color.B;
+		default:
+			check(Channel == 3);
+			return Color.A;
 		}
-
-		return FLinearColor::Black;
 	}
 
-	int32 GetPixelIndexForCoordinates(FIntVector2 VertexCoords) const;
+	static FORCEINLINE uint8 GetChannelValue(const FColor& Color, int32 Channel)
+	{
+		switch (Channel)
+		{
+		case 0:
+			return Color.R;
+		case 1:
+			return Color.G;
+		case 2:
+			return Color.B;
+		default:
+			check(Channel == 3);
+			return Color.A;
+		}
+	}
 };
 
 USTRUCT(Blueprintable)
@@ -96,11 +104,16 @@ struct FHeightBasedLandscapeData
 	FGrassTypeSettings Grass;
 };
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FRuntimeLandscapeBuildProgressDelegate, int32, BuiltComponentAmount,
+                                             int32, TotalComponentAmount);
+
 UCLASS(Blueprintable, BlueprintType)
 class RUNTIMEEDITABLELANDSCAPE_API ARuntimeLandscape : public AActor
 {
 	GENERATED_BODY()
 
+	friend class FRuntimeLandscapeDeltaSave;
+
 public:
 	// Sets default values for this actor's properties
 	ARuntimeLandscape();
@@ -117,16 +130,105 @@ public:
 	 * NOTE: Requires 'Navigation Mesh->Runtime->Runtime Generation->Dynamic' in the project settings
 	 */
 	uint8 bUpdateNavigation : 1 = 1;
+	UPROPERTY(EditAnywhere, Category = "Performance", meta = (EditCondition = "bUpdateNavigation", ClampMin = 0))
+	/**
+	 * Navigation is only updated if no rebuild finished for this time in seconds,
+	 * so continuous edits (i.e. dragging a layer) are submitted once they settle
+	 * 0 submits all changes of a frame on the next tick
+	 */
+	float NavigationUpdateDelay = 0.25f;
+	UPROPERTY(EditAnywhere, Category = "Performance", meta = (ClampMin = 0))
+	/**
+	 * The max height error in units of the navigation geometry
+	 * Flat areas are exported with fewer triangles, holes are always preserved
+	 */
+	float NavigationGeometryTolerance = 10.0f;
+	UPROPERTY(EditAnywhere, Category = "Performance", meta = (ClampMin = 1))
+	/**
+	 * The max amount of rebuilt components that are applied per frame
+	 * Building is spread across all worker threads, but applying the meshes has to happen on the game thread
+	 */
+	int32 MaxRebuildCommitsPerFrame = 4;
+	UPROPERTY(EditAnywhere, Category = "Performance")
+	/**
+	 * Store the generated normals, tangents and grass of every component with the level
+	 * Components only generate them again on load if the heights, weights or grass settings changed
+	 */
+	bool bUseMeshCache = false;
+	UPROPERTY(BlueprintAssignable)
+	/** Called whenever a component of a full landscape build is finished */
+	FRuntimeLandscapeBuildProgressDelegate OnBuildProgress;
 
 	/**
 	 * Adds a new layer to the landscape
 	 * @param LayerToAdd The added landscape layer
 	 */
 	void AddLandscapeLayer(const ULandscapeLayerComponent* LayerToAdd);
-	void DrawGroundType(const ULandscapeGroundTypeData* GroundType, ELayerShape Shape, const FTransform& WorldTransform, const FVector& BrushExtent);
+	/**
+	 * Paints a ground type onto the landscape
+	 * The brush is rasterized on the CPU, the layer render target is updated from the result if it exists
+	 * @param GroundType		The painted ground type
+	 * @param Shape				The brush shape
+	 * @param WorldTransform	The brush transform, only location and yaw are used
+	 * @param BrushExtent		The half size of the brush
+	 * @param Falloff			The distance from the brush edge in which the brush strength fades out
+	 */
+	void DrawGroundType(const ULandscapeGroundTypeData* GroundType, ELayerShape Shape, const FTransform& WorldTransform,
+	                    const FVector& BrushExtent, float Falloff = 0.0f);
 	void RemoveLandscapeLayer(const ULandscapeLayerComponent* Layer);
+	/**
+	 * Write the effect of a layer into the landscape heights and holes and remove the layer
+	 * Committed layers are not applied on every rebuild anymore and can be reverted with snapshots
+	 * Layers that overlap a layer that is applied before them can't be committed, since they would change the order
+	 * @param Layer	The committed layer, its owner can be destroyed afterwards
+	 * @return false if the layer was not committed
+	 */
+	bool CommitLandscapeLayer(const ULandscapeLayerComponent* Layer);
+	/**
+	 * Take a snapshot of the committed heights and holes (i.e. for undo)
+	 * Only references the height tiles, so it is cheap enough to be taken every frame
+	 */
+	FRuntimeLandscapeSnapshot CreateSnapshot() const;
+	/**
+	 * Restore the committed heights and holes of a snapshot
+	 * Only components whose tiles differ from the snapshot are rebuilt
+	 */
+	void RestoreSnapshot(const FRuntimeLandscapeSnapshot& Snapshot);
+	UFUNCTION(BlueprintCallable)
+	/**
+	 * Write the height, hole and ground type changes since the landscape was baked into a compact binary format
+	 * Only the state of finished rebuilds is saved
+	 * @param OutData	Receives the data, i.e. to store it in a save game
+	 */
+	void SaveEdits(TArray<uint8>& OutData) const;
+	UFUNCTION(BlueprintCallable)
+	/**
+	 * Restore edits written by SaveEdits, the changed components are rebuilt
+	 * The saved state replaces the layers that created it, so these layers should not be spawned again
+	 * @return false if the data could not be loaded completely
+	 */
+	bool LoadEdits(const TArray<uint8>& Data);
+	UFUNCTION(BlueprintCallable, Category = "Profiling")
+	/**
+	 * Get the latency percentiles in milliseconds from an edit until all of its components are committed
+	 * Covers adding, removing and moving layers and painting ground types
+	 * @return The amount of measured edits
+	 */
+	int32 GetEditLatencyPercentiles(float& OutP50, float& OutP95, float& OutP99) const;
+	UFUNCTION(BlueprintCallable, Category = "Profiling")
+	void ResetEditLatency() { EditTracker.ResetLatency(); }
+	FORCEINLINE FRuntimeLandscapeEditTracker& GetEditTracker() { return EditTracker; }
+	/** Replace the ground types whose weights are only available on the CPU */
+	void SetAdditionalGroundTypes(const TArray<TObjectPtr<const ULandscapeGroundTypeData>>& GroundTypes);
 	TMap<const ULandscapeGroundTypeData*, float> GetGroundTypeLayerWeightsAtVertexCoordinates(
 		int32 SectionIndex, int32 X, int32 Y) const;
+	/**
+	 * Get the ground type with the highest weight for every vertex of a component
+	 * @param SectionIndex	The id of the component
+	 * @param OutPlanes		Receives the dominant plane per vertex (GROUND_TYPE_PLANE_NONE if there is none)
+	 * @param OutWeights	Receives the weight of the dominant plane per vertex
+	 */
+	void GetDominantGroundTypes(int32 SectionIndex, TArray<uint8>& OutPlanes, TArray<uint8>& OutWeights) const;
 
 	/** Get the amount of vertices in a single component */
 	FORCEINLINE int32 GetTotalVertexAmountPerComponent() const
@@ -146,28 +248,68 @@ public:
 	FORCEINLINE const FVector2D& GetComponentResolution() const { return ComponentResolution; }
 	FORCEINLINE float GetQuadSideLength() const { return QuadSideLength; }
 	FORCEINLINE float GetParentHeight() const { return ParentHeight; }
-	FORCEINLINE float GetAreaPerSquare() const { return AreaPerSquare; }
-	FORCEINLINE TArray<FHeightBasedLandscapeData> GetHeightBasedData() const { return HeightBasedData; }
-	FORCEINLINE const AInstancedFoliageActor* GetFoliageActor() const { return FoliageActor; }
-	FORCEINLINE const TMap<TEnumAsByte<ELayerShape>, FGroundTypeBrushData>& GetGroundTypeBrushes() const
+
+	/**
+	 * Convert a world height to the 16 bit height storage
+	 * Only heights within +-32768 * HeightScale of the stored range center are storable,
+	 * heights outside of it are clamped and a warning is logged
+	 */
+	FORCEINLINE uint16 QuantizeHeight(float Height) const
+	{
+		const int32 QuantizedHeight = FMath::RoundToInt((Height - HeightOffset) / HeightScale);
+		if (QuantizedHeight < 0 || QuantizedHeight > MAX_uint16)
+		{
+			WarnHeightClamped(Height);
+			return FMath::Clamp(QuantizedHeight, 0, MAX_uint16);
+		}
+
+		return QuantizedHeight;
+	}
+
+	/** Convert a stored 16 bit height to a world height */
+	FORCEINLINE float DequantizeHeight(uint16 QuantizedHeight) const
 	{
-		return GroundTypeBrushes;
+		return HeightOffset + QuantizedHeight * HeightScale;
 	}
 
-	const FRuntimeLandscapeGroundTypeLayerSet* TryGetLayerSetForGroundType(
+	FORCEINLINE float GetAreaPerSquare() const { return AreaPerSquare; }
+	FORCEINLINE int32 GetGrassSeed() const { return GrassSeed; }
+	FORCEINLINE const TArray<FHeightBasedLandscapeData>& GetHeightBasedData() const { return HeightBasedData; }
+	FORCEINLINE const FGrassRuleTable& GetGrassRules() const { return *GrassRules; }
+	/** Get the current grass rules, the table is replaced instead of changed, so rebuilds can keep using it */
+	FORCEINLINE const TSharedRef<const FGrassRuleTable>& GetGrassRulesSnapshot() const { return GrassRules; }
+	FORCEINLINE bool IsGrassClustered() const { return bClusterGrass; }
+	FORCEINLINE const AInstancedFoliageActor* GetFoliageActor() const { return FoliageActor; }
+
+	/**
+	 * Get the location of the ground type in the weight storage
+	 * @return nullptr if the ground type is not used by this landscape
+	 */
+	FORCEINLINE const FGroundTypeLayerIndex* TryGetGroundTypeLayerIndex(
 		const ULandscapeGroundTypeData* GroundType) const
 	{
-		for (const FRuntimeLandscapeGroundTypeLayerSet& LayerSet : GroundLayerSets)
-		{
-			if (LayerSet.GroundTypes.Contains(GroundType))
-			{
-				return &LayerSet;
-			}
-		}
+		return GroundTypeLayerIndices.Find(GroundType);
+	}
 
-		return nullptr;
+	/** Get the amount of ground types, which is also the amount of weight planes per component */
+	FORCEINLINE int32 GetGroundTypeAmount() const { return GroundTypesByPlane.Num(); }
+	FORCEINLINE const ULandscapeGroundTypeData* GetGroundTypeForPlane(int32 Plane) const
+	{
+		return GroundTypesByPlane[Plane];
 	}
 
+	/**
+	 * Mark a changed area for the navigation update
+	 * All areas are submitted together once no change was added for NavigationUpdateDelay
+	 */
+	void AddNavigationDirtyArea(const FBox& Area);
+
+	/**
+	 * Update the instances of the component in the grass clusters that overlap it
+	 * @return The amount of instances that were added, moved or removed
+	 */
+	int32 UpdateGrassClusters(const URuntimeLandscapeComponent& ChangedComponent);
+
 	/**
 	 * Get the ids for the sections contained in the specified area
 	 * Sections are numbered like this (i.e. ComponentAmount = 4x4):
@@ -177,6 +319,11 @@ public:
 	 * 15	16	17	18	19
 	 */
 	TArray<URuntimeLandscapeComponent*> GetComponentsInArea(const FBox2D& Area) const;
+	/**
+	 * Get the world bounds of a rect of landscape vertices to look up the affected components
+	 * @param VertexArea	The landscape vertex coordinates, the max is exclusive
+	 */
+	FBox2D GetVertexAreaBounds(const FIntRect& VertexArea) const;
 
 	/**
 	 * Get the grid coordinates of the specified component
@@ -201,6 +348,8 @@ public:
 	                                         FIntVector2& OutCoordinateResult) const;
 
 	FVector GetOriginLocation() const;
+	/** Get the area covered by the landscape in world coordinates */
+	FBox2D GetWorldBounds() const;
 	FBox2D GetComponentBounds(int32 SectionIndex) const;
 
 protected:
@@ -215,6 +364,54 @@ protected:
 	TObjectPtr<AInstancedFoliageActor> FoliageActor;
 	UPROPERTY(EditAnywhere)
 	TArray<FHeightBasedLandscapeData> HeightBasedData;
+	UPROPERTY(EditAnywhere, Category = "Grass")
+	/**
+	 * Seed for grass placement
+	 * The same seed always produces the same grass instances for the same terrain
+	 */
+	int32 GrassSeed = 0;
+	UPROPERTY(EditAnywhere, Category = "Grass")
+	/**
+	 * Only generate grass for components near the player views
+	 * Grass of other components is released in least recently viewed order when the instance budget is exceeded
+	 */
+	bool bStreamGrass = false;
+	UPROPERTY(EditAnywhere, Category = "Grass", meta = (EditCondition = "bStreamGrass", ClampMin = 0))
+	/** Grass is generated for components within this distance to a player view */
+	float GrassStreamingRadius = 20000.0f;
+	UPROPERTY(EditAnywhere, Category = "Grass", meta = (EditCondition = "bStreamGrass", ClampMin = 0))
+	/**
+	 * The amount of grass instances that may be kept for components outside the streaming radius
+	 * 0 releases the grass as soon as a component leaves the radius
+	 */
+	int32 GrassInstanceBudget = 500000;
+	UPROPERTY(EditAnywhere, Category = "Grass", meta = (EditCondition = "bStreamGrass", ClampMin = 0.1))
+	/** The interval in seconds in which the player views are checked */
+	float GrassStreamingInterval = 0.5f;
+	UPROPERTY(EditAnywhere, Category = "Streaming")
+	/**
+	 * Only keep the mesh, collision and grass of components near the player views
+	 * Components outside the radius only keep their heights and edit data and are rebuilt on approach
+	 */
+	bool bStreamComponents = false;
+	UPROPERTY(EditAnywhere, Category = "Streaming", meta = (EditCondition = "bStreamComponents", ClampMin = 0))
+	/** Components within this distance to a player view are streamed in */
+	float ComponentStreamingRadius = 50000.0f;
+	UPROPERTY(EditAnywhere, Category = "Streaming", meta = (EditCondition = "bStreamComponents", ClampMin = 0))
+	/** Components are streamed out beyond the radius plus this distance, so they don't toggle at the border */
+	float ComponentStreamingHysteresis = 5000.0f;
+	UPROPERTY(EditAnywhere, Category = "Streaming", meta = (EditCondition = "bStreamComponents", ClampMin = 0.1))
+	/** The interval in seconds in which the player views are checked */
+	float ComponentStreamingInterval = 0.5f;
+	UPROPERTY(EditAnywhere, Category = "Grass")
+	/**
+	 * Group the grass of all components into clusters owned by the landscape,
+	 * so fewer instanced meshes have to be culled and drawn
+	 */
+	bool bClusterGrass = false;
+	UPROPERTY(EditAnywhere, Category = "Grass", meta = (EditCondition = "bClusterGrass", ClampMin = 100))
+	/** The side length of a grass cluster in units, rounded to full quads */
+	float GrassClusterSize = 12800.0f;
 	UPROPERTY(EditAnywhere)
 	/**
 	* RenderTargets for the ground layers.
@@ -223,9 +420,13 @@ protected:
 	*/
 	TArray<FRuntimeLandscapeGroundTypeLayerSet> GroundLayerSets;
 	UPROPERTY(EditAnywhere)
-	float PaintLayerResolution = 0.01f;
+	/**
+	 * Ground types that are not mirrored to a render target
+	 * Their weights are only available on the CPU (i.e. for grass or gameplay)
+	 */
+	TArray<TObjectPtr<const ULandscapeGroundTypeData>> AdditionalGroundTypes;
 	UPROPERTY(EditAnywhere)
-	TMap<TEnumAsByte<ELayerShape>, FGroundTypeBrushData> GroundTypeBrushes;
+	float PaintLayerResolution = 0.01f;
 	UPROPERTY(EditAnywhere)
 	bool bBakeLayersOnBeginPlay = true;
 	UPROPERTY()
@@ -243,8 +444,18 @@ protected:
 	UPROPERTY()
 	TArray<TObjectPtr<URuntimeLandscapeComponent>> LandscapeComponents;
 	UPROPERTY()
+	/** The grass clusters in row order, only used if bClusterGrass is set */
+	TArray<FRuntimeLandscapeGrassCluster> GrassClusters;
+	UPROPERTY()
+	/**
+	 * The height of a single step of the parent landscape, used as the step of the 16 bit height storage
+	 * This limits the storable heights to a range of 65535 * HeightScale around the initial heights
+	 */
 	float HeightScale = 1.0f;
 	UPROPERTY()
+	/** The world height of the stored height 0 */
+	float HeightOffset = 0.0f;
+	UPROPERTY()
 	/** The side length of a single component in units (components are always squares) */
 	float ComponentSize;
 	UPROPERTY()
@@ -255,20 +466,91 @@ protected:
 	float ParentHeight;
 
 	bool bIsRebuilding;
+	/** Set once clamping a height was reported, so edits outside the storable range don't spam the log */
+	mutable std::atomic<bool> bHasWarnedHeightClamped = false;
+	FTimerHandle GrassStreamingTimer;
+	FTimerHandle ComponentStreamingTimer;
+	FTimerHandle NavigationUpdateTimer;
+	/** Correlates edits with the component rebuilds they cause and measures their latency */
+	FRuntimeLandscapeEditTracker EditTracker;
+	/** Changed world areas that were not submitted to the navigation system yet, overlapping areas are merged */
+	TArray<FBox> NavigationDirtyAreas;
+	/** Maps the ground types to their location in the weight storage */
+	TMap<const ULandscapeGroundTypeData*, FGroundTypeLayerIndex> GroundTypeLayerIndices;
+	/** The ground types in the order of their weight planes */
+	TArray<const ULandscapeGroundTypeData*> GroundTypesByPlane;
+	/** The grass settings of the ground types and height based data, compiled for fast lookup */
+	TSharedRef<const FGrassRuleTable> GrassRules = MakeShared<FGrassRuleTable>();
 
 	UFUNCTION(BlueprintCallable)
 	void BakeLandscapeLayers();
 
 	UFUNCTION()
 	void HandleLandscapeLayerOwnerDestroyed(AActor* DestroyedActor);
+	/** Registers the landscape again, so the subsystem grid matches the moved bounds */
+	void HandleTransformUpdated(USceneComponent* SceneComponent, EUpdateTransformFlags UpdateTransformFlags,
+	                            ETeleportType Teleport);
 	
+	/** Assigns a weight plane to every ground type */
+	void UpdateGroundTypeLayerIndices();
+	/** Compiles the grass rules, has to be called when the ground types or the height based data change */
+	void UpdateGrassRules();
+	/**
+	 * Updates the component weight tiles from the render target of the provided ground type layer
+	 */
+	void UpdateVertexLayerWeights(int32 LayerSetIndex);
+	/**
+	 * Uploads the CPU weights of the specified area to the layer render target
+	 * Does nothing if there is no render target (i.e. on dedicated servers)
+	 * @param LayerSetIndex	The updated layer set
+	 * @param Area			The updated area in pixel coordinates (Max is exclusive)
+	 */
+	void UpdateRenderTargetFromWeights(int32 LayerSetIndex, const FIntRect& Area) const;
+	/** Log a warning the first time a height is outside of the 16 bit height storage range */
+	void WarnHeightClamped(float Height) const;
+	/** Submit all navigation dirty areas in a single batch */
+	void FlushNavigationDirtyAreas();
+	/** Get the locations of all local player views */
+	void GetViewLocations(TArray<FVector>& OutViewLocations) const;
+	/**
+	 * Enables grass for components near the player views
+	 * and releases grass of components that were not viewed for the longest time if the budget is exceeded
+	 */
+	void UpdateGrassStreaming();
+	/**
+	 * Streams in components near the player views, nearest first, and streams out components that left the radius
+	 * Keeps the current state while there is no player view
+	 */
+	void UpdateComponentStreaming();
+	/** Get the side length of a grass cluster in vertices */
+	int32 GetGrassClusterVertexAmount() const
+	{
+		return FMath::Max(FMath::RoundToInt(GrassClusterSize / QuadSideLength), 1);
+	}
+
+	/** Get the amount of grass clusters in each direction */
+	FIntPoint GetGrassClusterAmount() const
+	{
+		return FIntPoint::DivideAndRoundUp(GetWeightMapSize(), GetGrassClusterVertexAmount());
+	}
+
 	/**
-	 * Updates the vertex layer weights for the provided ground type layer
+	 * Replace the instances a component owns in a grass cluster with its generated grass
+	 * The instances of the other components in the cluster are kept
+	 * @return The amount of instances that were added, moved or removed
 	 */
-	static void UpdateVertexLayerWeights(FRuntimeLandscapeGroundTypeLayerSet& LayerSet);
+	int32 UpdateGrassCluster(const FIntPoint& Cluster, const URuntimeLandscapeComponent& ChangedComponent);
+	/** Get the size of the ground type weight maps, which have a pixel for every vertex */
+	FIntPoint GetWeightMapSize() const
+	{
+		return FIntPoint(FMath::RoundToInt(MeshResolution.X) + 1, FMath::RoundToInt(MeshResolution.Y) + 1);
+	}
 
 	virtual void PostLoad() override;
+	/** Registers the landscape before any layer begins play, so layers can find it */
+	virtual void PostInitializeComponents() override;
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 #if WITH_EDITORONLY_DATA
 
@@ -299,23 +581,37 @@ public:
 	FColor DebugColor2 = FColor::Emerald;
 	UPROPERTY(EditAnywhere, Category = "Debug")
 	TObjectPtr<UMaterial> DebugMaterial;
+	UPROPERTY()
+	/** The material brushes of levels that were saved before brushes were rasterized, cleared when loaded */
+	TMap<TEnumAsByte<ELayerShape>, FGroundTypeBrushData> GroundTypeBrushes_DEPRECATED;
 
 	UFUNCTION(BlueprintCallable)
 	void InitializeFromLandscape();
+	/**
+	 * Create the components from a heightmap instead of the parent landscape (i.e. for benchmarks)
+	 * @param InComponentAmount		The amount of components in each direction
+	 * @param ComponentSizeQuads	The amount of quads along the side of a component
+	 * @param InQuadSideLength		The side length of a quad in units
+	 * @param Heights				The heights relative to the actor in row order,
+	 *								(InComponentAmount * ComponentSizeQuads + 1) vertices in each direction
+	 */
+	void InitializeFromHeightmap(const FIntPoint& InComponentAmount, int32 ComponentSizeQuads, float InQuadSideLength,
+	                             const TArray<float>& Heights);
 
 	void Rebuild();
+	/**
+	 * Replace all components, layers that affected the old components are added again
+	 * @param ComponentHeightValues	The heights relative to the parent height of every component, in component order
+	 * @param ComponentLocations	The world location of every component, in component order
+	 */
+	void CreateComponents(const TArray<TArray<float>>& ComponentHeightValues,
+	                      const TArray<FVector>& ComponentLocations);
+	/** Quantize the float heights of components that were saved before heights were stored as 16 bit */
+	void ConvertDeprecatedHeights();
+	/** Release the material brushes of landscapes that were saved before brushes were rasterized */
+	void ConvertDeprecatedGroundTypeBrushes();
 	virtual void PreInitializeComponents() override;
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 
-	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override
-	{
-		if (EndPlayReason == EEndPlayReason::Type::EndPlayInEditor)
-		{
-			BakeLandscapeLayers();
-		}
-
-		Super::EndPlay(EndPlayReason);
-	}
-
 #endif
 };
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RuntimeEditableLandscape.h"
+#include "Commandlets/Commandlet.h"
+#include "RuntimeLandscapeBenchmarkCommandlet.generated.h"
+
+#if WITH_EDITOR
+class AActor;
+class ARuntimeLandscape;
+class FJsonObject;
+class ULandscapeGroundTypeData;
+
+UCLASS()
+/**
+ * Builds a synthetic landscape in a headless world, applies scripted batches of layers and writes a json report
+ * of the throughput, the stage timings, the edit latency and the peak memory
+ *
+ * Run with: UnrealEditor-Cmd <Project> -run=RuntimeLandscapeBenchmark -nullrhi -unattended
+ *	-ComponentAmount=8		The amount of components in each direction
+ *	-ComponentQuads=63		The amount of quads along the side of a component
+ *	-QuadSize=100			The side length of a quad in units
+ *	-Batches=16				The amount of layer batches
+ *	-LayersPerBatch=8		The amount of layers per batch, cycling through height, hole, vertex color and ground type
+ *	-Seed=0					The seed of the heights and layer placement
+ *	-FrameRate=60			Frames are paced to this rate, 0 ticks as fast as possible
+ *	-Timeout=300			Seconds until a build that did not finish is aborted
+ *	-Output=<Path>			The report file, defaults to Saved/Benchmarks/RuntimeLandscape-<Time>.json
+ */
+class RUNTIMEEDITABLELANDSCAPE_API URuntimeLandscapeBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	URuntimeLandscapeBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/** The minimum duration of a frame, 0 if frames are not paced */
+	double FrameTime = 1.0 / 60.0;
+	double Timeout = 300.0;
+	/** The highest tracked memory of each type that was sampled after a frame */
+	TStaticArray<int64, static_cast<int32>(ERuntimeLandscapeMemory::Num)> PeakTrackedMemory;
+	int64 PeakTotalTrackedMemory = 0;
+
+	/**
+	 * Tick the world until the landscape has no queued or running rebuilds
+	 * @return false if the timeout was reached
+	 */
+	bool TickUntilIdle(UWorld* World, const ARuntimeLandscape* Landscape);
+	void SampleMemory();
+	/** Spawn an actor with a layer component of the type, which is applied once it is registered */
+	AActor* SpawnLayer(UWorld* World, int32 LayerType, const FVector& Location, const FVector& Extent,
+	                   const ULandscapeGroundTypeData* GroundType, FRandomStream& Random) const;
+	TSharedRef<FJsonObject> CreateStageReport() const;
+	TSharedRef<FJsonObject> CreateMemoryReport() const;
+};
+
+#endif
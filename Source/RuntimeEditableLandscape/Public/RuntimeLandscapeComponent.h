@@ -3,9 +3,15 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "GroundTypeWeightTile.h"
 #include "LandscapeGrassType.h"
 #include "LandscapeLayerActor.h"
 #include "ProceduralMeshComponent.h"
+#include "RuntimeLandscapeFoliageMask.h"
+#include "RuntimeLandscapeHeightTiles.h"
+#include "RuntimeLandscapeMeshCache.h"
+#include "Grass/LandscapeGrassData.h"
+#include "Grass/RuntimeLandscapeGrassMesh.h"
 #include "RuntimeLandscapeComponent.generated.h"
 
 
@@ -21,10 +27,14 @@ class RUNTIMEEDITABLELANDSCAPE_API URuntimeLandscapeComponent : public UProcedur
 	GENERATED_BODY()
 
 	friend class ARuntimeLandscape;
+	friend class FGenerateAdditionalVertexDataWorker;
 	friend class FGenerateVerticesWorker;
+	friend class FRuntimeLandscapeDeltaSave;
 	friend class URuntimeLandscapeRebuildManager;
 
 public:
+	URuntimeLandscapeComponent();
+
 	void AddLandscapeLayer(const ULandscapeLayerComponent* Layer);
 
 	void SetHoleFlagForVertex(int32 VertexIndex, bool bValue)
@@ -39,11 +49,7 @@ public:
 		}
 	}
 
-	void RemoveLandscapeLayer(const ULandscapeLayerComponent* Layer)
-	{
-		AffectingLayers.Remove(Layer);
-		Rebuild();
-	}
+	void RemoveLandscapeLayer(const ULandscapeLayerComponent* Layer);
 
 	void Initialize(int32 ComponentIndex, const TArray<float>& HeightValuesInitial);
 
@@ -54,13 +60,37 @@ public:
 	}
 
 	FORCEINLINE int32 GetComponentIndex() const { return Index; }
+	FORCEINLINE bool IsGrassEnabled() const { return bIsGrassEnabled; }
+	/**
+	 * Enable or disable grass for this component
+	 * Disabling releases all grass instances, enabling regenerates them
+	 */
+	void SetGrassEnabled(bool bEnabled);
+	FORCEINLINE bool IsStreamedIn() const { return bIsStreamedIn; }
+	/**
+	 * Stream the component in or out
+	 * Streamed out components release their mesh, collision and grass and only keep their heights and edit data,
+	 * streaming in rebuilds them
+	 */
+	void SetStreamedIn(bool bStreamedIn);
+	/** Get the amount of grass instances of all grass meshes */
+	int32 GetGrassInstanceAmount() const;
+	FORCEINLINE const FGroundTypeWeightTile& GetGroundTypeWeights() const { return GroundTypeWeights; }
 
 	FVector2D GetRelativeVertexLocation(int32 VertexIndex) const;
 	virtual void DestroyComponent(bool bPromoteChildren = false) override;
+	/** Exports a simplified heightfield instead of the full resolution collision */
+	virtual bool DoCustomNavigableGeometryExport(FNavigableGeometryExport& GeomExport) const override;
 
 protected:
 	UPROPERTY()
-	TArray<float> InitialHeightValues = TArray<float>();
+	/** The heights of the parent landscape, quantized with the height scale and offset of the landscape */
+	TArray<uint16> InitialHeights;
+#if WITH_EDITORONLY_DATA
+	UPROPERTY()
+	/** The world heights before they were quantized, converted when the landscape is loaded */
+	TArray<float> InitialHeightValues_DEPRECATED;
+#endif
 	UPROPERTY()
 	/** All vertices that are inside at least one hole */
 	TSet<int32> VerticesInHole = TSet<int32>();
@@ -72,19 +102,154 @@ protected:
 	UPROPERTY()
 	int32 Index;
 	UPROPERTY()
-	TArray<UHierarchicalInstancedStaticMeshComponent*> GrassMeshes;
-
-	TArray<float> HeightValues = TArray<float>();
+	/** Grass meshes are kept across rebuilds and only updated where the grass changed */
+	TArray<FRuntimeLandscapeGrassMesh> GrassMeshes;
+	UPROPERTY()
+	/** The ground type weights of all vertices in this component */
+	FGroundTypeWeightTile GroundTypeWeights;
+	UPROPERTY()
+	/** The generated data of the last rebuild in the editor, only used if the landscape uses the mesh cache */
+	FRuntimeLandscapeMeshCache MeshCache;
+
+	/**
+	 * The heights and holes that were restored from saved edits or committed from layers
+	 * Used instead of the initial heights, layers are applied on top
+	 */
+	FRuntimeLandscapeHeightTiles EditedHeights;
+	/** The delta save tiles whose ground type weights were painted since the weights were baked */
+	TBitArray<> EditedWeightTiles;
+	/** The quantized heights of the last rebuild */
+	TArray<uint16> HeightValues;
+	/** The vertices that were in a hole on the last rebuild */
+	TSet<int32> BuiltVerticesInHole;
+	/** The grass of the last rebuild, reprojected instead of regenerated if only heights change */
+	FLandscapeGrassData GeneratedGrass;
+	/**
+	 * The vertex normals the generated grass was aligned to
+	 * The grass was placed on the heights of the last rebuild
+	 */
+	TArray<FVector> GrassVertexNormals;
+	/** Incremented whenever the ground type weights change */
+	uint32 GroundTypeWeightsVersion = 0;
+	/** The ground type weights version the generated grass is based on */
+	uint32 GrassWeightsVersion = 0;
+	FRuntimeLandscapeFoliageMask FoliageMask;
+	/** The world area in which layers were added or removed since the foliage mask was updated */
+	FBox2D FoliageDirtyArea = FBox2D(ForceInit);
+	/** The bounds of the affecting layers when they were added, so moved layers restore their previous area */
+	TMap<TObjectPtr<const ULandscapeLayerComponent>, FBox2D> AffectingLayerBounds;
+
+	FORCEINLINE void MarkGroundTypeWeightsChanged() { ++GroundTypeWeightsVersion; }
+	/** Get the height the layers are applied to */
+	FORCEINLINE uint16 GetBaseHeight(int32 VertexIndex) const
+	{
+		return EditedHeights.GetHeight(VertexIndex, InitialHeights);
+	}
 
-	UHierarchicalInstancedStaticMeshComponent* FindOrAddGrassMesh(const FGrassVariety& Variety);
+	/**
+	 * Write the effect of a layer into the edited heights and holes
+	 * Only the edited tiles are duplicated if they are shared with a snapshot
+	 */
+	void CommitLandscapeLayer(const ULandscapeLayerComponent* Layer);
+	/** Whether no layer that is applied before the layer overlaps it, so committing it keeps the result */
+	bool CanCommitLandscapeLayer(const ULandscapeLayerComponent* Layer) const;
+
+	/** Get the height of the last rebuild relative to the component */
+	float GetBuiltHeightRelative(int32 VertexIndex) const;
+	/** Whether existing grass can be reprojected to new heights, because the ground type weights did not change */
+	bool CanReprojectGrass() const;
+	/** Release all grass instances and the generated grass data */
+	void ReleaseGrass();
+	/** Release the mesh and the grass of a streamed out component, must not be called while it is rebuilding */
+	void ReleaseStreamedOutData();
+
+	/** @return The index of the grass mesh of the variety, it is created if it does not exist yet */
+	int32 FindOrAddGrassMesh(const FGrassVariety& Variety);
+	/**
+	 * Create the grass meshes of the generated grass that do not exist yet
+	 * Called before the grass trees are built, since the trees depend on the instanced meshes
+	 * @param GrassData				The generated grass
+	 * @param OutGrassMeshIndices	Receives the grass mesh index of every mesh buffer, INDEX_NONE for empty buffers
+	 */
+	void AddGrassMeshes(const FLandscapeGrassData& GrassData, TArray<int32>& OutGrassMeshIndices);
+	FORCEINLINE const FRuntimeLandscapeGrassMesh& GetGrassMesh(int32 GrassMeshIndex) const
+	{
+		return GrassMeshes[GrassMeshIndex];
+	}
+	/**
+	 * Update the pooled grass meshes to match the grass of the rebuild
+	 * Prebuilt grass trees are moved out of the buffer
+	 */
+	void UpdateGrass(FRuntimeLandscapeRebuildBuffer& RebuildBuffer);
+	/**
+	 * Update the grass meshes owned by this component
+	 * @return The amount of instances that were added, moved or removed
+	 */
+	int32 UpdateGrassMeshes(FRuntimeLandscapeRebuildBuffer& RebuildBuffer);
 	void Rebuild();
+	/** Rebuild the grass only, the mesh, collision and navigation stay untouched */
+	void RebuildGrass();
 	void ApplyDataFromLayers(TArray<float>& OutHeightValues, TArray<FColor>& OutVertexColors);
-	void UpdateNavigation();
-	void RemoveFoliageAffectedByLayer() const;
+	/**
+	 * Hash all inputs of the mesh and grass generation
+	 * @param BuiltHeightValues	The heights with all layers applied
+	 */
+	uint32 CalculateMeshCacheHash(const TArray<float>& BuiltHeightValues) const;
+	/**
+	 * Store the built heights and holes
+	 * @return The world bounds of the vertices whose height or hole state changed
+	 */
+	FBox UpdateBuiltHeights(const FRuntimeLandscapeRebuildBuffer& RebuildBuffer);
+	/**
+	 * Refresh the navigation geometry and mark the changed area dirty
+	 * @param ChangedBounds	The changed world area, only this area is rebuilt on the nav mesh
+	 */
+	void UpdateNavigation(const FBox& ChangedBounds);
+	/**
+	 * Add the triangles of a heightfield area to the navigation geometry
+	 * The area is split until the triangles are within the navigation tolerance and contain no holes
+	 * @param Min				The first vertex coordinates of the area
+	 * @param Max				The last vertex coordinates of the area
+	 * @param HoleVertices		Whether each vertex is in a hole
+	 * @param OutVertices		The relative vertices of the triangles
+	 * @param OutIndices		The triangle indices
+	 */
+	void AppendNavigationArea(const FIntPoint& Min, const FIntPoint& Max, const TBitArray<>& HoleVertices,
+	                          TArray<FVector>& OutVertices, TArray<int32>& OutIndices) const;
+	/** Hide foliage covered by the affecting layers and restore uncovered foliage inside the dirty area */
+	void UpdateFoliageMask();
 
 	/** Applies data to the landscape after all threads are finished */
-	void FinishRebuild(const FRuntimeLandscapeRebuildBuffer& RebuildBuffer);
+	void FinishRebuild(FRuntimeLandscapeRebuildBuffer& RebuildBuffer);
+	/** Report the memory of the heights, weights and grass to the stats */
+	void UpdateMemoryStats();
+	/** Remove the reported memory from the stats */
+	void ReleaseMemoryStats();
+
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
 
 private:
 	bool bIsStale;
+	/** Whether the queued rebuild only has to update the grass */
+	bool bOnlyGrassIsStale;
+	/** Whether the rebuild was started, changes after that might be missed by the workers */
+	bool bIsRebuilding = false;
+	/** Whether the component changed while it was rebuilding, it is queued again once the rebuild finished */
+	bool bIsRebuildRequested = false;
+	/** Whether the rebuild that was requested while rebuilding only has to update the grass */
+	bool bIsOnlyGrassRebuildRequested = false;
+	bool bIsGrassEnabled = true;
+	/** Rebuilds of streamed out components are skipped, streaming in rebuilds them */
+	bool bIsStreamedIn = true;
+	/** The last time the component was inside the grass streaming radius of a player view */
+	double LastGrassViewTime = 0.0;
+	/** The edits that were applied after the last rebuild started, they are passed to the next rebuild */
+	FRuntimeLandscapeEditIds PendingEditIds;
+	/** The cycles when the component was queued for a rebuild */
+	uint64 QueuedCycles = 0;
+	/** The memory that was last reported to the stats */
+	int64 TrackedHeightMemory = 0;
+	int64 TrackedWeightMemory = 0;
+	int64 TrackedGrassMemory = 0;
 };
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GroundTypeWeightTile.h"
+#include "RuntimeLandscapeHeightTiles.h"
+
+class ARuntimeLandscape;
+class URuntimeLandscapeComponent;
+
+/**
+ * Compact binary format for the runtime edits of a landscape (i.e. for save games)
+ * Every component is split into square tiles, only tiles that differ from the baked base are stored:
+ * - height tiles store the difference of the committed heights to the initial heights (zig-zag and variable length
+ *   encoded), layers are not included since they are applied again when loading
+ * - hole tiles store a bit per committed hole
+ * - weight tiles store the ground type weights of tiles that were painted since the weights were baked
+ */
+class RUNTIMEEDITABLELANDSCAPE_API FRuntimeLandscapeDeltaSave
+{
+public:
+	/** Increase when the data layout changes, data of other versions can not be loaded */
+	static constexpr int32 CurrentVersion = 2;
+	/** The side length of a tile in vertices, matches the height tiles so only edited tiles have to be compared */
+	static constexpr int32 TileSize = FRuntimeLandscapeHeightTile::TileSize;
+
+	/**
+	 * Write the committed heights, holes and painted weights of all components
+	 * @param Landscape	The saved landscape
+	 * @param OutData	Receives the binary data
+	 */
+	static void Write(const ARuntimeLandscape& Landscape, TArray<uint8>& OutData);
+	/**
+	 * Apply saved edits to the component buffers and rebuild the changed components
+	 * The components are decoded in parallel and applied afterwards, layers that exist when loading are applied on top
+	 * Components that are queued or rebuilding are rebuilt again with the loaded edits
+	 * Expects the weights to be in their baked state (i.e. right after the level was loaded)
+	 * @return false if the data is invalid or was saved for a landscape with a different layout
+	 */
+	static bool Apply(ARuntimeLandscape& Landscape, const TArray<uint8>& Data);
+	/**
+	 * Mark the weight tiles that contain the area as edited, so they are included in the save
+	 * @param Component	The painted component
+	 * @param LocalArea	The painted vertex area within the component (Max is exclusive)
+	 */
+	static void MarkWeightsEdited(URuntimeLandscapeComponent& Component, const FIntRect& LocalArea);
+
+private:
+	/** The decoded edits of a single component, applied to the component once all components are decoded */
+	struct FComponentEdits
+	{
+		FRuntimeLandscapeHeightTiles Heights;
+		/** The weights of the component with the saved tiles replaced, only set if weight tiles were saved */
+		FGroundTypeWeightTile Weights;
+		TBitArray<> EditedWeightTiles;
+		bool bHasWeights = false;
+	};
+
+	/** Get the amount of tiles in each direction of a component */
+	static FIntPoint GetTileAmount(const ARuntimeLandscape& Landscape);
+	/** Get the vertex area of a tile within its component (Max is exclusive) */
+	static FIntRect GetTileArea(const ARuntimeLandscape& Landscape, int32 TileIndex);
+
+	/**
+	 * Encode the edits of a single component
+	 * @return false if the component has no edits, nothing useful was written in that case
+	 */
+	static bool WriteComponent(const URuntimeLandscapeComponent& Component, FArchive& Ar);
+	/**
+	 * Decode the data of a single component, the component is not changed so it can run on any thread
+	 * @param Component		The restored component
+	 * @param Ar			The component data
+	 * @param PlaneMapping	The current weight plane of every saved ground type, INDEX_NONE if it does not exist anymore
+	 * @param HeightScale	The height scale the landscape had when saving
+	 * @param OutEdits		Receives the decoded edits
+	 * @return false if the data could not be read
+	 */
+	static bool ReadComponent(const URuntimeLandscapeComponent& Component, FArchive& Ar,
+	                          const TArray<int32>& PlaneMapping, float HeightScale, FComponentEdits& OutEdits);
+};
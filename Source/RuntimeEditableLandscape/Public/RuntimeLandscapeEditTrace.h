@@ -0,0 +1,174 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+#include "Trace/Trace.h"
+
+class ARuntimeLandscape;
+
+#define RUNTIME_LANDSCAPE_TRACE_ENABLED (UE_TRACE_ENABLED && !UE_BUILD_SHIPPING)
+
+#if RUNTIME_LANDSCAPE_TRACE_ENABLED
+/** Enable with -trace=RuntimeLandscape to record the edits and rebuild stages in Unreal Insights */
+UE_TRACE_CHANNEL_EXTERN(RuntimeLandscapeChannel, RUNTIMEEDITABLELANDSCAPE_API)
+#endif
+
+enum class ERuntimeLandscapeEditType : uint8
+{
+	AddLayer,
+	RemoveLayer,
+	MoveLayer,
+	DrawGroundType
+};
+
+/** The traced steps between queueing a component and committing its rebuild */
+enum class ERuntimeLandscapeTraceStage : uint8
+{
+	/** From queueing the component until its rebuild starts */
+	Queued,
+	ApplyLayers,
+	BuildVertices,
+	GenerateGrass,
+	BuildGrassTrees,
+	UpdateGrass,
+	CommitMesh,
+	Foliage,
+	Navigation
+};
+
+/** The ids of the edits a component rebuild applies */
+typedef TArray<uint32, TInlineAllocator<2>> FRuntimeLandscapeEditIds;
+
+/**
+ * Histogram of latencies in milliseconds with exponentially growing buckets
+ * Percentiles are reported as the upper bound of their bucket, so they are off by at most the bucket growth
+ */
+class RUNTIMEEDITABLELANDSCAPE_API FRuntimeLandscapeLatencyHistogram
+{
+public:
+	/** The upper bound of the first bucket */
+	static constexpr double MinLatencyMs = 0.5;
+	/** The factor between the upper bounds of consecutive buckets */
+	static constexpr double BucketGrowth = 1.2;
+	/** Covers latencies up to ~48 seconds, higher latencies are counted in the last bucket */
+	static constexpr int32 BucketAmount = 64;
+
+	FRuntimeLandscapeLatencyHistogram() : Buckets(InPlace, 0)
+	{
+	}
+
+	void AddSample(double LatencyMs);
+	/**
+	 * Get the latency that the percentile of the samples did not exceed
+	 * @param Percentile	The percentile in the range [0, 100]
+	 * @return 0 if there are no samples
+	 */
+	double GetPercentile(double Percentile) const;
+	FORCEINLINE int64 GetSampleAmount() const { return SampleAmount; }
+	FORCEINLINE double GetMaxLatency() const { return MaxLatencyMs; }
+	void Reset();
+
+private:
+	TStaticArray<int64, BucketAmount> Buckets;
+	int64 SampleAmount = 0;
+	double MaxLatencyMs = 0.0;
+};
+
+/**
+ * Correlates edits of a landscape with the component rebuilds they cause
+ * Every edit gets an id that is carried from the queued components through the rebuild stages to the commit,
+ * the edit is finished once all of its components are committed
+ * All functions are called on the game thread
+ */
+class RUNTIMEEDITABLELANDSCAPE_API FRuntimeLandscapeEditTracker
+{
+public:
+	/**
+	 * Begin an edit, components that are queued until EndEdit is called are attached to it
+	 * Nested edits are merged into the outer edit
+	 * @return The id of the edit
+	 */
+	uint32 BeginEdit(ERuntimeLandscapeEditType Type, const ARuntimeLandscape& Landscape);
+	void EndEdit();
+	/**
+	 * Attach the current edit to a queued component
+	 * @param ComponentIndex	The index of the component
+	 * @param InOutEditIds		The edits the component was not rebuilt for yet
+	 */
+	void AttachEdit(int32 ComponentIndex, FRuntimeLandscapeEditIds& InOutEditIds);
+	/** Called when a component committed or skipped its rebuild, finishes the edits without remaining components */
+	void FinishEdits(TConstArrayView<uint32> EditIds);
+
+	FORCEINLINE const FRuntimeLandscapeLatencyHistogram& GetLatency() const { return Latency; }
+	FORCEINLINE void ResetLatency() { Latency.Reset(); }
+
+private:
+	struct FPendingEdit
+	{
+		uint64 StartCycles = 0;
+		/** The amount of attached components that did not commit yet */
+		int32 RemainingComponents = 0;
+		ERuntimeLandscapeEditType Type = ERuntimeLandscapeEditType::AddLayer;
+	};
+
+	TMap<uint32, FPendingEdit> PendingEdits;
+	/** The edit that is attached to queued components, 0 if there is none */
+	uint32 CurrentEditId = 0;
+	int32 EditDepth = 0;
+	FRuntimeLandscapeLatencyHistogram Latency;
+
+	void FinishEdit(uint32 EditId, const FPendingEdit& Edit);
+};
+
+/** Begins an edit of the landscape for the lifetime of the scope */
+class RUNTIMEEDITABLELANDSCAPE_API FRuntimeLandscapeEditScope
+{
+public:
+	FRuntimeLandscapeEditScope(ARuntimeLandscape& Landscape, ERuntimeLandscapeEditType Type);
+	~FRuntimeLandscapeEditScope();
+
+	FRuntimeLandscapeEditScope(const FRuntimeLandscapeEditScope&) = delete;
+	FRuntimeLandscapeEditScope& operator=(const FRuntimeLandscapeEditScope&) = delete;
+
+private:
+	FRuntimeLandscapeEditTracker& Tracker;
+};
+
+#if RUNTIME_LANDSCAPE_TRACE_ENABLED
+/**
+ * Traces a rebuild stage of a component with the edits it applies for the lifetime of the scope
+ * The edit ids are copied, since workers end the scope after the game thread could have reused the rebuild slot
+ */
+class RUNTIMEEDITABLELANDSCAPE_API FRuntimeLandscapeStageTraceScope
+{
+public:
+	FRuntimeLandscapeStageTraceScope(ERuntimeLandscapeTraceStage InStage, int32 InComponentIndex,
+	                                 TConstArrayView<uint32> InEditIds);
+	~FRuntimeLandscapeStageTraceScope();
+
+	/**
+	 * Trace a stage that already ended
+	 * @param StartCycles	The cycles when the stage started
+	 */
+	static void Output(ERuntimeLandscapeTraceStage Stage, int32 ComponentIndex, TConstArrayView<uint32> EditIds,
+	                   uint64 StartCycles);
+
+private:
+	FRuntimeLandscapeEditIds EditIds;
+	uint64 StartCycles;
+	int32 ComponentIndex;
+	ERuntimeLandscapeTraceStage Stage;
+	bool bIsEnabled;
+};
+
+#define RUNTIME_LANDSCAPE_TRACE_STAGE(Stage, ComponentIndex, EditIds) \
+	const FRuntimeLandscapeStageTraceScope PREPROCESSOR_JOIN(RuntimeLandscapeStageTrace, __LINE__)( \
+		ERuntimeLandscapeTraceStage::Stage, ComponentIndex, EditIds)
+#define RUNTIME_LANDSCAPE_TRACE_STAGE_SINCE(Stage, ComponentIndex, EditIds, StartCycles) \
+	FRuntimeLandscapeStageTraceScope::Output(ERuntimeLandscapeTraceStage::Stage, ComponentIndex, EditIds, StartCycles)
+#else
+#define RUNTIME_LANDSCAPE_TRACE_STAGE(Stage, ComponentIndex, EditIds)
+#define RUNTIME_LANDSCAPE_TRACE_STAGE_SINCE(Stage, ComponentIndex, EditIds, StartCycles)
+#endif
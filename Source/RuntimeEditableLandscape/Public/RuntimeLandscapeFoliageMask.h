@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AInstancedFoliageActor;
+class UHierarchicalInstancedStaticMeshComponent;
+
+/**
+ * Hides foliage instances that are covered by landscape layers and restores them when the layers are removed
+ * Instances are bucketed into a grid, so only instances inside changed areas are tested
+ */
+class RUNTIMEEDITABLELANDSCAPE_API FRuntimeLandscapeFoliageMask
+{
+public:
+	FORCEINLINE bool IsInitialized() const { return bIsInitialized; }
+
+	/**
+	 * Collect the foliage instances inside the area
+	 * @param Foliage		The foliage actor
+	 * @param InArea		The world area, instances on the max border are not included
+	 * @param InCellAmount	The amount of grid cells in each direction
+	 */
+	void Initialize(const AInstancedFoliageActor& Foliage, const FBox2D& InArea, int32 InCellAmount = 16);
+	/**
+	 * Hide or restore the instances inside the changed area
+	 * @param ChangedArea	The world area in which the mask changed
+	 * @param IsMasked		Whether instances at the world location should be hidden
+	 * @return The amount of hidden or restored instances
+	 */
+	int32 Update(const FBox2D& ChangedArea, TFunctionRef<bool(const FVector2D&)> IsMasked);
+	/** Restore all hidden instances */
+	void RestoreAll();
+
+private:
+	/** The instances of a single foliage component, sorted by cell */
+	struct FMaskedFoliage
+	{
+		TWeakObjectPtr<UHierarchicalInstancedStaticMeshComponent> FoliageComponent;
+		TArray<int32> Instances;
+		/** The world transform of every instance before it was hidden */
+		TArray<FTransform> OriginalTransforms;
+		TBitArray<> HiddenInstances;
+		/** The instances of a cell are CellOffsets[Cell] to CellOffsets[Cell + 1] */
+		TArray<int32> CellOffsets;
+	};
+
+	TArray<FMaskedFoliage> MaskedFoliage;
+	FBox2D Area = FBox2D(ForceInit);
+	FVector2D CellSize = FVector2D::One();
+	int32 CellAmount = 0;
+	bool bIsInitialized = false;
+
+	FORCEINLINE FIntPoint GetCell(const FVector2D& Location) const
+	{
+		const FVector2D Cell = (Location - Area.Min) / CellSize;
+		return FIntPoint(FMath::Clamp(FMath::FloorToInt(Cell.X), 0, CellAmount - 1),
+		                 FMath::Clamp(FMath::FloorToInt(Cell.Y), 0, CellAmount - 1));
+	}
+
+	/** Show or hide a single instance, does not mark the render state dirty */
+	static void SetInstanceHidden(FMaskedFoliage& Foliage, int32 Entry, bool bHidden);
+};
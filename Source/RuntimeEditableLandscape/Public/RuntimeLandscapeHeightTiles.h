@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+#include "Containers/StaticBitArray.h"
+#include "Templates/RefCounting.h"
+
+/**
+ * The heights and holes of a square area of a component
+ * Shared between the component and its snapshots until one of them edits it
+ */
+class FRuntimeLandscapeHeightTile : public FThreadSafeRefCountedObject
+{
+public:
+	/** The side length of a tile in vertices */
+	static constexpr int32 TileSize = 16;
+
+	/** The quantized heights in tile row order, entries outside the component are unused */
+	TStaticArray<uint16, TileSize * TileSize> Heights;
+	TStaticBitArray<TileSize * TileSize> Holes;
+};
+
+/**
+ * Copy-on-write storage for the edited heights and holes of a component
+ * Tiles that were never edited are not allocated and use the initial heights of the component
+ * Copying the storage only copies the tile references, shared tiles are duplicated when they are edited
+ */
+struct RUNTIMEEDITABLELANDSCAPE_API FRuntimeLandscapeHeightTiles
+{
+	/** Allocate the tile references for the vertex layout of a component, existing tiles are kept if it matches */
+	void Initialize(const FIntVector2& VertexAmount);
+	/** Release all tiles, so the initial heights are used again */
+	void Reset();
+
+	FORCEINLINE bool IsEmpty() const { return EditedTileAmount == 0; }
+
+	/**
+	 * Get the height of a vertex
+	 * @param VertexIndex		The vertex within the component
+	 * @param InitialHeights	The initial heights of the component, used for tiles that were not edited
+	 */
+	FORCEINLINE uint16 GetHeight(int32 VertexIndex, const TArray<uint16>& InitialHeights) const
+	{
+		if (IsEmpty())
+		{
+			return InitialHeights[VertexIndex];
+		}
+
+		int32 LocalIndex;
+		const FRuntimeLandscapeHeightTile* Tile = Tiles[GetTileIndex(VertexIndex, LocalIndex)];
+		return Tile ? Tile->Heights[LocalIndex] : InitialHeights[VertexIndex];
+	}
+
+	/** Whether a vertex is flagged as hole */
+	FORCEINLINE bool IsHole(int32 VertexIndex) const
+	{
+		if (IsEmpty())
+		{
+			return false;
+		}
+
+		int32 LocalIndex;
+		const FRuntimeLandscapeHeightTile* Tile = Tiles[GetTileIndex(VertexIndex, LocalIndex)];
+		return Tile && Tile->Holes[LocalIndex];
+	}
+
+	/** Set the height of a vertex, duplicates the tile if it is shared */
+	void SetHeight(int32 VertexIndex, uint16 Height, const TArray<uint16>& InitialHeights);
+	/** Set the hole flag of a vertex, duplicates the tile if it is shared */
+	void SetHole(int32 VertexIndex, bool bIsHole, const TArray<uint16>& InitialHeights);
+	/** Get the memory of the tile references and the edited tiles, shared tiles are counted by every owner */
+	FORCEINLINE SIZE_T GetAllocatedSize() const
+	{
+		return Tiles.GetAllocatedSize() + EditedTileAmount * sizeof(FRuntimeLandscapeHeightTile);
+	}
+
+	/** Add all vertices that are flagged as hole */
+	void GetHoles(TSet<int32>& OutVerticesInHole) const;
+	/** Whether both storages reference the same tiles, so their content is equal without comparing it */
+	FORCEINLINE bool HasSameTiles(const FRuntimeLandscapeHeightTiles& Other) const
+	{
+		return (IsEmpty() && Other.IsEmpty()) || Tiles == Other.Tiles;
+	}
+
+private:
+	/** The tiles in row order, nullptr for tiles that were not edited */
+	TArray<TRefCountPtr<FRuntimeLandscapeHeightTile>> Tiles;
+	FIntVector2 VertexAmount = FIntVector2::ZeroValue;
+	int32 TileAmountX = 0;
+	int32 EditedTileAmount = 0;
+
+	FORCEINLINE int32 GetTileIndex(int32 VertexIndex, int32& OutLocalIndex) const
+	{
+		const int32 X = VertexIndex % VertexAmount.X;
+		const int32 Y = VertexIndex / VertexAmount.X;
+		constexpr int32 TileSize = FRuntimeLandscapeHeightTile::TileSize;
+		OutLocalIndex = X % TileSize + Y % TileSize * TileSize;
+		return X / TileSize + Y / TileSize * TileAmountX;
+	}
+
+	/** Get a tile that is only referenced by this storage, allocating or duplicating it if required */
+	FRuntimeLandscapeHeightTile& GetMutableTile(int32 TileIndex, const TArray<uint16>& InitialHeights);
+};
+
+/**
+ * The edited heights and holes of all components of a landscape
+ * Only references the tiles, so taking and restoring snapshots is cheap
+ * Ground type weights are not part of the snapshot
+ */
+struct RUNTIMEEDITABLELANDSCAPE_API FRuntimeLandscapeSnapshot
+{
+	/** The edited heights of every component, in component order */
+	TArray<FRuntimeLandscapeHeightTiles> ComponentHeights;
+};
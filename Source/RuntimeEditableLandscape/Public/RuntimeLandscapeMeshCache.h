@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RuntimeLandscapeMeshCache.generated.h"
+
+class FGrassRuleTable;
+class ULandscapeGrassType;
+struct FRuntimeLandscapeRebuildBuffer;
+
+USTRUCT()
+/**
+ * The generated data of a component, stored with the level so loading does not have to generate it again
+ * Only valid as long as the hash of the generation inputs matches
+ */
+struct RUNTIMEEDITABLELANDSCAPE_API FRuntimeLandscapeMeshCache
+{
+	GENERATED_BODY()
+
+	/** Increase when the data layout or the generation changes, caches of other versions are discarded */
+	static constexpr int32 CurrentVersion = 1;
+
+	/**
+	 * Check if the cache can be used
+	 * @param InputHash			The hash of the current generation inputs
+	 * @param bRequiresGrass	Whether the cache has to contain the grass
+	 */
+	bool IsValid(uint32 InputHash, bool bRequiresGrass) const
+	{
+		return Version == CurrentVersion && Hash == InputHash && (bHasGrass || !bRequiresGrass) && Data.Num() > 0;
+	}
+
+	/**
+	 * Store the generated data of the rebuild
+	 * @param Buffer		The finished rebuild buffer
+	 * @param GrassRules	The grass rules the grass was generated with, used to find the grass types of the meshes
+	 * @param bInHasGrass	Whether the grass was generated
+	 */
+	void Store(const FRuntimeLandscapeRebuildBuffer& Buffer, const FGrassRuleTable& GrassRules, bool bInHasGrass);
+	/**
+	 * Restore the normals, tangents and grass to the rebuild buffer
+	 * @return false if the cache could not be read, the buffer has to be generated in that case
+	 */
+	bool Restore(FRuntimeLandscapeRebuildBuffer& OutBuffer) const;
+	void Reset();
+
+private:
+	UPROPERTY()
+	int32 Version = INDEX_NONE;
+	UPROPERTY()
+	/** The hash of the generation inputs, see URuntimeLandscapeComponent::CalculateMeshCacheHash */
+	uint32 Hash = 0;
+	UPROPERTY()
+	bool bHasGrass = false;
+	UPROPERTY()
+	/** The grass types of the cached grass meshes, referenced by index from the data */
+	TArray<TObjectPtr<const ULandscapeGrassType>> GrassTypes;
+	UPROPERTY()
+	/**
+	 * Packed normals and tangents followed by the grass instances
+	 * Heights are not stored, since they are part of the hash and have to be calculated anyway
+	 */
+	TArray<uint8> Data;
+};
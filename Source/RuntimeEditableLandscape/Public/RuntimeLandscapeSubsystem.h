@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RuntimeLandscapeSubsystem.generated.h"
+
+class ARuntimeLandscape;
+
+/**
+ * Registry of the runtime landscapes of a world
+ * Landscapes are stored in a uniform grid, so layers only resolve the landscapes they overlap
+ */
+UCLASS()
+class RUNTIMEEDITABLELANDSCAPE_API URuntimeLandscapeSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Add the landscape with its current world bounds, registering it again updates the bounds */
+	void RegisterLandscape(ARuntimeLandscape* Landscape);
+	void UnregisterLandscape(const ARuntimeLandscape* Landscape);
+	/**
+	 * Get the landscapes whose world bounds overlap the area
+	 * @param Area			The area in world coordinates
+	 * @param OutLandscapes	Receives the overlapping landscapes
+	 */
+	void GetLandscapesInArea(const FBox2D& Area, TArray<ARuntimeLandscape*>& OutLandscapes) const;
+
+private:
+	/** The side length of a grid cell in units */
+	static constexpr double CellSize = 100000.0;
+
+	struct FRegisteredLandscape
+	{
+		TWeakObjectPtr<ARuntimeLandscape> Landscape;
+		FBox2D Bounds;
+	};
+
+	TSparseArray<FRegisteredLandscape> Landscapes;
+	/** The ids of the landscapes that overlap each grid cell */
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<1>>> Cells;
+
+	/** Get the first and last grid cell that overlap the area */
+	static void GetCellRange(const FBox2D& Area, FIntPoint& OutFirstCell, FIntPoint& OutLastCell);
+};
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RuntimeLandscapeRebuildManager.h"
+
+/**
+ * Thread that is used to build the sorted instances and the cluster tree of a single grass mesh,
+ * so the game thread only has to swap in the finished tree
+ */
+class FBuildGrassTreeWorker : public IQueuedWork
+{
+	friend class URuntimeLandscapeRebuildManager;
+
+public:
+	FBuildGrassTreeWorker(URuntimeLandscapeRebuildManager* RebuildManager, FRuntimeLandscapeRebuildSlot* Slot);
+	virtual ~FBuildGrassTreeWorker() override;
+
+private:
+	TObjectPtr<URuntimeLandscapeRebuildManager> RebuildManager;
+	/** The rebuild slot the worker generates data for */
+	FRuntimeLandscapeRebuildSlot* Slot = nullptr;
+	/** The grass tree in the rebuild buffer that is built by this worker */
+	int32 TreeIndex = INDEX_NONE;
+
+	void QueueWork(int32 InTreeIndex)
+	{
+		TreeIndex = InTreeIndex;
+		RebuildManager->ThreadPool->AddQueuedWork(this);
+	}
+
+	virtual void DoThreadedWork() override;
+
+	virtual void Abandon() override
+	{
+		RebuildManager->CancelRebuild(*Slot);
+	}
+};
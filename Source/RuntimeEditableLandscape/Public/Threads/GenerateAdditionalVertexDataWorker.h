@@ -8,6 +8,12 @@
 struct FGrassVariety;
 class ULandscapeGrassType;
 class URuntimeLandscapeRebuildManager;
+
+namespace RuntimeLandscapeKernels
+{
+	struct FGrassVariety;
+}
+
 /**
  * Runner that generates additional vertex info
  * run when all vertices are generated in the RLRS_BuildAdditionalData stage
@@ -17,21 +23,51 @@ class RUNTIMEEDITABLELANDSCAPE_API FGenerateAdditionalVertexDataWorker : public
 	friend class URuntimeLandscapeRebuildManager;
 
 public:
-	FGenerateAdditionalVertexDataWorker(URuntimeLandscapeRebuildManager* RebuildManager);
+	FGenerateAdditionalVertexDataWorker(URuntimeLandscapeRebuildManager* RebuildManager,
+	                                    FRuntimeLandscapeRebuildSlot* Slot);
 	~FGenerateAdditionalVertexDataWorker();
 
+	/** Copy the placement settings of the variety for the grass kernels */
+	static RuntimeLandscapeKernels::FGrassVariety MakeKernelVariety(const FGrassVariety& Variety);
+
 private:
 	int32 YCoordinate = 0;
 	int32 StartIndex = 0;
 	FVector2D UV1Offset = FVector2D();
 	TObjectPtr<URuntimeLandscapeRebuildManager> RebuildManager;
+	/** The rebuild slot the worker generates data for */
+	FRuntimeLandscapeRebuildSlot* Slot = nullptr;
+	/** The dominant ground type plane for each vertex in the row, taken from the rebuild buffer */
+	TConstArrayView<uint8> RowDominantPlanes;
+	/** The weight of the dominant ground type for each vertex in the row */
+	TConstArrayView<uint8> RowDominantWeights;
+	/** The grass generated for the row */
+	FLandscapeGrassData GrassData;
+	/** The grass rules the rebuild started with, set when the work starts */
+	const FGrassRuleTable* GrassRules = nullptr;
+	/** The world height of the current component */
+	float ComponentHeight = 0.0f;
+	/** The next instance of every previous grass mesh buffer, used when reprojecting grass */
+	TArray<int32> PreviousGrassCursors;
 
 	void GenerateGrassDataForVertex(const int32 VertexIndex, int32 X);
-	void GenerateGrassTransformsAtVertex(const FGrassTypeSettings* SelectedGrass, const int32 VertexIndex,
-	                                        float Weight) const;
-	void GetRandomGrassRotation(const FGrassVariety& Variety, FRotator& OutRotation) const;
-	void GetRandomGrassLocation(const FVector& VertexRelativeLocation, FVector& OutGrassLocation) const;
-	void GetRandomGrassScale(const FGrassVariety& Variety, FVector& OutScale) const;
+	/**
+	 * Select the grass rule of a vertex in the current row
+	 * @param X						The vertex column
+	 * @param VertexHeightRelative	The vertex height relative to the component
+	 * @param Normal				The vertex normal
+	 * @return INDEX_NONE if no grass is placed
+	 */
+	int32 SelectGrassRule(int32 X, float VertexHeightRelative, const FVector& Normal) const;
+	/** Move the previous grass instances of the vertex to the new vertex height and normal */
+	void ReprojectGrassAtVertex(int32 VertexIndex);
+	void GenerateGrassTransformsAtVertex(const ULandscapeGrassType* GrassType, const int32 VertexIndex, float Weight);
+	/**
+	 * Get the random stream for the specified vertex
+	 * The stream is seeded from the landscape grass seed, the component and the vertex,
+	 * so the same terrain always produces the same grass independent of the thread that generates it
+	 */
+	FRandomStream GetVertexRandomStream(int32 VertexIndex) const;
 
 	void QueueWork(int32 Y, int32 VertexStartIndex, const FVector2D& InUV1Offset)
 	{
@@ -45,6 +81,6 @@ private:
 
 	virtual void Abandon() override
 	{
-		RebuildManager->CancelRebuild();
+		RebuildManager->CancelRebuild(*Slot);
 	}
 };
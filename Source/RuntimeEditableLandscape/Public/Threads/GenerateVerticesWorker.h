@@ -19,11 +19,13 @@ class FGenerateVerticesWorker : public IQueuedWork
 	friend class URuntimeLandscapeRebuildManager;
 
 public:
-	FGenerateVerticesWorker(URuntimeLandscapeRebuildManager* RebuildManager);
+	FGenerateVerticesWorker(URuntimeLandscapeRebuildManager* RebuildManager, FRuntimeLandscapeRebuildSlot* Slot);
 	virtual ~FGenerateVerticesWorker() override;
 
 private:
 	TObjectPtr<URuntimeLandscapeRebuildManager> RebuildManager;
+	/** The rebuild slot the worker generates data for */
+	FRuntimeLandscapeRebuildSlot* Slot = nullptr;
 	FVector2D UV1Offset;
 
 	void QueueWork(FVector2D InUV1Offset)
@@ -36,6 +38,6 @@ private:
 
 	virtual void Abandon() override
 	{
-		RebuildManager->CancelRebuild();
+		RebuildManager->CancelRebuild(*Slot);
 	}
 };
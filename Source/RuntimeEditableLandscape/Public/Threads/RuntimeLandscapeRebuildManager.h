@@ -3,13 +3,16 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "LandscapeGrassType.h"
+#include "RuntimeEditableLandscape.h"
 #include "RuntimeLandscape.h"
 #include "Components/ActorComponent.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Grass/LandscapeGrassData.h"
 #include "RuntimeLandscapeRebuildManager.generated.h"
 
 
 struct FProcMeshTangent;
+class FBuildGrassTreeWorker;
 class FGenerateAdditionalVertexDataWorker;
 class FGenerateVerticesWorker;
 class ARuntimeLandscape;
@@ -19,23 +22,29 @@ enum ERuntimeLandscapeRebuildState : uint8
 {
 	RLRS_None,
 	RLRS_BuildVertices,
-	RLRS_BuildAdditionalData
+	RLRS_BuildAdditionalData,
+	RLRS_BuildGrassTrees,
+	/** All data is generated, waits until the commit budget of the frame allows applying it to the component */
+	RLRS_Commit
 };
 
-struct FLandscapeGrassVertexData
+/**
+ * Cluster tree of a single grass mesh that is built on a worker thread
+ * The instances are stored in the order of the tree, so they can be passed to the instanced mesh directly
+ */
+struct FLandscapeGrassTree
 {
-	FGrassVariety GrassVariety;
-	TArray<FTransform> InstanceTransformsRelative;
-};
-
-struct FLandscapeAdditionalData
-{
-	TMap<const UStaticMesh*, FLandscapeGrassVertexData> GrassData;
-
-	void ClearData()
-	{
-		GrassData.Empty();
-	}
+	/** The mesh buffer in the grass data that contains the instances */
+	int32 MeshBufferIndex = INDEX_NONE;
+	int32 DesiredInstancesPerLeaf = 0;
+	FBox MeshBox = FBox(ForceInit);
+
+	TArray<FInstancedStaticMeshInstanceData> InstanceData;
+	TArray<FClusterNode> ClusterTree;
+	int32 OcclusionLayerNum = 0;
+	TArray<FTransform> SortedTransforms;
+	/** The vertex of every sorted instance */
+	TArray<int32> SortedVertices;
 };
 
 USTRUCT()
@@ -63,9 +72,49 @@ struct FRuntimeLandscapeRebuildBuffer
 	TArray<FProcMeshTangent> Tangents;
 
 	// Additional data
-	TArray<FLandscapeAdditionalData> AdditionalData;
+	/** Grass of all vertices, concatenated from the outputs of the additional data runners */
+	FLandscapeGrassData GrassData;
+	/** The grass rules of the landscape when the rebuild started */
+	TSharedPtr<const FGrassRuleTable> GrassRules;
+	/**
+	 * The dominant ground type plane of every vertex, copied when the grass generation starts
+	 * The workers read the copy, since painting changes the weights of the component on the game thread
+	 */
+	TArray<uint8> DominantGroundTypePlanes;
+	/** The weight of the dominant ground type of every vertex */
+	TArray<uint8> DominantGroundTypeWeights;
+	/** Whether the existing grass of the component is reprojected where the grass selection did not change */
+	bool bReprojectGrass = false;
+	/** The ground type weights version of the component when the grass was generated */
+	uint32 GrassWeightsVersion = 0;
+	/** Trees of the grass meshes that are replaced entirely */
+	TArray<FLandscapeGrassTree> GrassTrees;
+	/** The hash of the generation inputs, only calculated if the mesh cache is used */
+	uint32 InputHash = 0;
+	/** Whether the normals, tangents and grass were restored from the mesh cache instead of being generated */
+	bool bIsRestoredFromCache = false;
+	/** The edits that are applied by this rebuild */
+	FRuntimeLandscapeEditIds EditIds;
 
 	ERuntimeLandscapeRebuildState RebuildState = ERuntimeLandscapeRebuildState::RLRS_None;
+
+	SIZE_T GetAllocatedSize() const;
+};
+
+/**
+ * A component that is rebuilt with its own buffer and runners
+ * Multiple slots are processed at the same time, so components are built concurrently
+ */
+struct FRuntimeLandscapeRebuildSlot
+{
+	URuntimeLandscapeComponent* Component = nullptr;
+	FRuntimeLandscapeRebuildBuffer DataBuffer;
+
+	FGenerateVerticesWorker* VertexRunner = nullptr;
+	TArray<FGenerateAdditionalVertexDataWorker*> AdditionalDataRunners;
+	/** Created on demand, since the amount depends on the grass meshes */
+	TArray<FBuildGrassTreeWorker*> GrassTreeRunners;
+	std::atomic<int32> ActiveRunners = 0;
 };
 
 USTRUCT()
@@ -89,84 +138,113 @@ class RUNTIMEEDITABLELANDSCAPE_API URuntimeLandscapeRebuildManager : public UAct
 {
 	GENERATED_BODY()
 
+	friend class FBuildGrassTreeWorker;
 	friend class FGenerateVerticesWorker;
 	friend class FGenerateAdditionalVertexDataWorker;
 
 public:
 	URuntimeLandscapeRebuildManager();
 	void QueueRebuild(URuntimeLandscapeComponent* ComponentToRebuild);
+	/**
+	 * Collect all queued rebuilds until EndBulkBuild is called instead of starting them
+	 * Used to build all components at once, i.e. when the landscape is created
+	 */
+	void BeginBulkBuild();
+	/** Rebuild all collected components concurrently on all worker threads */
+	void EndBulkBuild();
+	FORCEINLINE bool IsBulkBuilding() const { return bIsBulkBuilding; }
+	/** Whether components are queued or rebuilding */
+	bool IsRebuilding() const;
+	/** The amount of rebuilds that were committed to their component */
+	FORCEINLINE int32 GetFinishedRebuildAmount() const { return FinishedRebuildAmount; }
 	FORCEINLINE FQueuedThreadPool* GetThreadPool() const { return ThreadPool; }
 
-	FORCEINLINE void NotifyRunnerFinished(const FGenerateAdditionalVertexDataWorker* FinishedRunner)
-	{
-		--ActiveRunners;
-	}
-
-	FORCEINLINE void NotifyRunnerFinished(const FGenerateVerticesWorker* FinishedRunner)
+	FORCEINLINE void NotifyRunnerFinished(FRuntimeLandscapeRebuildSlot& Slot)
 	{
-		--ActiveRunners;
+		--Slot.ActiveRunners;
 	}
 
 	TArray<int32> GenerateTriangleArray(const TSet<int32>* HoleIndices) const;
 
 private:
-	UPROPERTY(VisibleAnywhere)
-	URuntimeLandscapeComponent* CurrentComponent = nullptr;
 	UPROPERTY(VisibleAnywhere)
 	TObjectPtr<ARuntimeLandscape> Landscape;
 	UPROPERTY(VisibleAnywhere)
 	FGenerationDataCache GenerationDataCache;
-	UPROPERTY(VisibleAnywhere)
-	FRuntimeLandscapeRebuildBuffer DataBuffer;
 	TQueue<URuntimeLandscapeComponent*> RebuildQueue;
-
-	FQueuedThreadPool* ThreadPool;
-	FGenerateVerticesWorker* VertexRunner;
-	TArray<FGenerateAdditionalVertexDataWorker*> AdditionalDataRunners;
-	std::atomic<int32> ActiveRunners;
+	/** The amount of components in the rebuild queue, since the queue can not be counted */
+	int32 QueuedRebuildAmount = 0;
+	/** The memory of the rebuild buffers that was last reported to the stats */
+	int64 TrackedBufferMemory = 0;
+	int32 FinishedRebuildAmount = 0;
+
+	/** Rebuilds of single components are polled at this interval, bulk builds are polled every frame */
+	static constexpr float DefaultTickInterval = 0.1f;
+
+	FQueuedThreadPool* ThreadPool = nullptr;
+	/** Slots are created on demand and reused, the amount of used slots is limited by MaxConcurrentRebuilds */
+	TArray<TUniquePtr<FRuntimeLandscapeRebuildSlot>> Slots;
+	/** A single component is rebuilt at a time, except for bulk builds */
+	int32 MaxConcurrentRebuilds = 1;
+
+	bool bIsBulkBuilding = false;
+	/** Whether the bulk build is collecting rebuilds, they are started when EndBulkBuild is called */
+	bool bIsCollectingBulkBuild = false;
+	int32 BulkBuildComponentAmount = 0;
+	int32 BulkBuildFinishedAmount = 0;
+	double BulkBuildStartTime = 0.0;
 
 	void Initialize()
 	{
-		if (AdditionalDataRunners.IsEmpty())
+		if (!ThreadPool)
 		{
 			Landscape = Cast<ARuntimeLandscape>(GetOwner());
 			check(Landscape);
 
-			InitializeBuffer();
 			InitializeGenerationCache();
-			InitializeRunners();
+			InitializeThreadPool();
 		}
 	}
 
 	void InitializeGenerationCache();
-	void InitializeRunners();
-	void InitializeBuffer();
-
-	/** 1st step: Rebuild vertex data on a single thread, since this is relatively fast */
-	void StartRebuild();
+	void InitializeThreadPool();
+	void InitializeSlot(FRuntimeLandscapeRebuildSlot& Slot);
+
+	/**
+	 * 1st step: Rebuild vertex data on a single thread, since this is relatively fast
+	 * @return false if the component has no valid data and is not rebuilt
+	 */
+	bool StartRebuild(FRuntimeLandscapeRebuildSlot& Slot);
+	/**
+	 * Restore the normals, tangents and grass of the rebuild buffer from the mesh cache of the component
+	 * Called by the vertex runner after the vertices were generated
+	 * @return false if the cache could not be read, the data has to be generated in that case
+	 */
+	bool RestoreFromCache(FRuntimeLandscapeRebuildSlot& Slot) const;
 	/** 2nd step: Rebuild additional data on multiple threads */
-	void StartGenerateAdditionalData();
-
-	void RebuildNextInQueue()
-	{
-		if (RebuildQueue.Dequeue(CurrentComponent))
-		{
-			StartRebuild();
-		}
-		else
-		{
-			CurrentComponent = nullptr;
-			SetComponentTickEnabled(false);
-		}
-	}
-
-	void CancelRebuild()
-	{
-		CurrentComponent = nullptr;
-		ActiveRunners = 0;
-		SetComponentTickEnabled(false);
-	}
+	void StartGenerateAdditionalData(FRuntimeLandscapeRebuildSlot& Slot);
+	/** Concatenate the grass data of all runners in row order */
+	void CollectGrassData(FRuntimeLandscapeRebuildSlot& Slot);
+	/**
+	 * 3rd step: Build the cluster trees of grass meshes that have to be replaced entirely on multiple threads
+	 * @return false if no tree has to be built
+	 */
+	bool StartBuildGrassTrees(FRuntimeLandscapeRebuildSlot& Slot);
+	/** Apply the generated data to the component and free the slot */
+	void FinishRebuild(FRuntimeLandscapeRebuildSlot& Slot);
+	/** Start queued rebuilds in free slots, disables the tick if nothing is left to do */
+	void RebuildNextInQueue();
+
+	/** Report the memory of the rebuild buffers of all slots to the stats */
+	void UpdateMemoryStats();
+
+	/**
+	 * Free the slot without applying the generated data, called for runners that are abandoned by the thread pool
+	 * The component is not rebuilt, so it can be queued again
+	 */
+	void CancelRebuild(FRuntimeLandscapeRebuildSlot& Slot);
 
 	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType,
 	                           FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void OnComponentDestroyed(bool bDestroyingHierarchy) override;
 };
@@ -32,7 +32,8 @@ public class RuntimeEditableLandscape : ModuleRules
 				"Landscape",
 				"Chaos",
 				"NavigationSystem",
-				"Foliage"
+				"Foliage",
+				"TraceLog"
 				// ... add other public dependencies that you statically link with here ...
 			}
 		);
@@ -44,7 +45,11 @@ public class RuntimeEditableLandscape : ModuleRules
 				"CoreUObject",
 				"Engine",
 				"Slate",
-				"SlateCore"
+				"SlateCore",
+				"RenderCore",
+				"RHI",
+				"Json",
+				"RuntimeEditableLandscapeKernels"
 				// ... add private dependencies that you statically link with here ...	
 			}
 		);
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RuntimeLandscapeKernels.h"
+
+namespace RuntimeLandscapeKernels
+{
+	void GenerateVertices(const FVertexGrid& Grid, TConstArrayView<float> Heights, TArrayView<FVector> OutVertices,
+	                      TArrayView<FVector2D> OutUV0, TArrayView<FVector2D> OutUV1)
+	{
+		const int32 VertexAmount = Grid.GetVertexAmount();
+		check(Heights.Num() >= VertexAmount && OutVertices.Num() >= VertexAmount && OutUV0.Num() >= VertexAmount
+			&& OutUV1.Num() >= VertexAmount);
+
+		int32 VertexIndex = 0;
+		for (int32 Y = 0; Y <= Grid.Resolution.Y; ++Y)
+		{
+			const float LocationY = Y * Grid.VertexDistance;
+			const float UVY = Y * Grid.UVIncrement;
+			for (int32 X = 0; X <= Grid.Resolution.X; ++X)
+			{
+				OutVertices[VertexIndex] = FVector(X * Grid.VertexDistance, LocationY,
+				                                   Heights[VertexIndex] + Grid.HeightOffset);
+				const FVector2D UV0(X * Grid.UVIncrement, UVY);
+				OutUV0[VertexIndex] = UV0;
+				OutUV1[VertexIndex] = UV0 * Grid.UV1Scale + Grid.UV1Offset;
+				++VertexIndex;
+			}
+		}
+	}
+
+	int32 GenerateTriangles(const FVertexGrid& Grid, TConstArrayView<bool> VerticesInHole,
+	                        TArrayView<int32> OutTriangles)
+	{
+		check(OutTriangles.Num() >= Grid.GetTriangleIndexAmount());
+		check(VerticesInHole.IsEmpty() || VerticesInHole.Num() >= Grid.GetVertexAmount());
+
+		const bool bHasHoles = !VerticesInHole.IsEmpty();
+		const int32 RowLength = Grid.Resolution.X + 1;
+		int32 Index = 0;
+		for (int32 Y = 0; Y < Grid.Resolution.Y; ++Y)
+		{
+			for (int32 X = 0; X < Grid.Resolution.X; ++X)
+			{
+				const int32 T1 = Y * RowLength + X;
+				const int32 T2 = T1 + RowLength;
+				const int32 T3 = T1 + 1;
+
+				if (bHasHoles && (VerticesInHole[T1] || VerticesInHole[T2] || VerticesInHole[T3]
+					|| VerticesInHole[T2 + 1]))
+				{
+					continue;
+				}
+
+				// add upper-left triangle
+				OutTriangles[Index++] = T1;
+				OutTriangles[Index++] = T2;
+				OutTriangles[Index++] = T3;
+
+				// add lower-right triangle
+				OutTriangles[Index++] = T3;
+				OutTriangles[Index++] = T2;
+				OutTriangles[Index++] = T2 + 1;
+			}
+		}
+
+		return Index;
+	}
+
+	int32 GetGrassInstanceAmount(const FGrassVariety& Variety, float AreaPerSquare, float Weight,
+	                             FRandomStream& RandomStream)
+	{
+		const float InstanceCount = AreaPerSquare * Variety.Density * 0.000001f * Weight;
+		int32 InstanceAmount = FMath::FloorToInt(InstanceCount);
+
+		// round up based on decimal remainder
+		const float Remainder = InstanceCount - InstanceAmount;
+		if (RandomStream.GetFraction() < Remainder)
+		{
+			++InstanceAmount;
+		}
+
+		return FMath::Max(InstanceAmount, 0);
+	}
+
+	void PlaceGrassInstances(const FGrassVariety& Variety, const FVector& VertexLocation,
+	                         const FQuat& SurfaceAlignment, float QuadSideLength, FRandomStream& RandomStream,
+	                         TArrayView<FTransform> OutTransforms)
+	{
+		for (FTransform& OutTransform : OutTransforms)
+		{
+			const float PosX = RandomStream.FRandRange(-0.5f, 0.5f);
+			const float PosY = RandomStream.FRandRange(-0.5f, 0.5f);
+			const FVector Location = VertexLocation + FVector(PosX * QuadSideLength, PosY * QuadSideLength, 0.0f);
+
+			FRotator Rotation = FRotator::ZeroRotator;
+			if (Variety.bRandomRotation)
+			{
+				Rotation.Yaw = RandomStream.FRandRange(-180.0f, 180.0f);
+			}
+
+			FVector Scale;
+			switch (Variety.Scaling)
+			{
+			case EGrassScaling::Uniform:
+				Scale = FVector(RandomStream.FRandRange(Variety.ScaleX.Min, Variety.ScaleX.Max));
+				break;
+			case EGrassScaling::Free:
+				Scale.X = RandomStream.FRandRange(Variety.ScaleX.Min, Variety.ScaleX.Max);
+				Scale.Y = RandomStream.FRandRange(Variety.ScaleY.Min, Variety.ScaleY.Max);
+				Scale.Z = RandomStream.FRandRange(Variety.ScaleZ.Min, Variety.ScaleZ.Max);
+				break;
+			case EGrassScaling::LockXY:
+				Scale.X = RandomStream.FRandRange(Variety.ScaleX.Min, Variety.ScaleX.Max);
+				Scale.Y = Scale.X;
+				Scale.Z = RandomStream.FRandRange(Variety.ScaleZ.Min, Variety.ScaleZ.Max);
+				break;
+			default:
+				checkNoEntry();
+				Scale = FVector::One();
+			}
+
+			OutTransform = FTransform(SurfaceAlignment * Rotation.Quaternion(), Location, Scale);
+		}
+	}
+}
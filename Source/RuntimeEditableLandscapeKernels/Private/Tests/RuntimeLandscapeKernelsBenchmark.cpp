@@ -0,0 +1,198 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RuntimeLandscapeKernels.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace RuntimeLandscapeKernelsBenchmark
+{
+	/** The amount of quads along the side of the benchmarked grids */
+	constexpr int32 GridSizes[] = {7, 15, 31, 63, 127, 255};
+	/** Every kernel is repeated until this many vertices were processed, so small grids are not dominated by noise */
+	constexpr int32 TargetVertexAmount = 1 << 21;
+	constexpr int32 MinIterations = 5;
+
+	/**
+	 * Time a kernel on a grid and report the fastest and the average iteration
+	 * The fastest iteration is the most stable value to compare optimizations
+	 */
+	template <typename KernelType>
+	void MeasureKernel(FAutomationTestBase& Test, const TCHAR* KernelName, int32 GridSize, int32 VertexAmount,
+	                   KernelType&& Kernel)
+	{
+		// warm up the caches and the allocations
+		Kernel();
+
+		const int32 Iterations = FMath::Max(MinIterations, TargetVertexAmount / VertexAmount);
+		uint64 MinCycles = MAX_uint64;
+		uint64 TotalCycles = 0;
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			Kernel();
+			const uint64 Cycles = FPlatformTime::Cycles64() - StartCycles;
+			MinCycles = FMath::Min(MinCycles, Cycles);
+			TotalCycles += Cycles;
+		}
+
+		const double MinMs = FPlatformTime::ToMilliseconds64(MinCycles);
+		const double AverageMs = FPlatformTime::ToMilliseconds64(TotalCycles) / Iterations;
+		Test.AddInfo(FString::Printf(
+			TEXT("%-18s %4ix%-4i min %8.4f ms, avg %8.4f ms, %6.2f ns per vertex (%i iterations)"), KernelName,
+			GridSize, GridSize, MinMs, AverageMs, MinMs * 1000000.0 / VertexAmount, Iterations));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRuntimeLandscapeKernelsBenchmark, "RuntimeEditableLandscape.Kernels.Benchmark",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FRuntimeLandscapeKernelsBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace RuntimeLandscapeKernels;
+	using namespace RuntimeLandscapeKernelsBenchmark;
+
+	constexpr float QuadSideLength = 100.0f;
+	constexpr int32 GrassSeed = 0;
+	constexpr int32 ComponentIndex = 0;
+	FRandomStream Random(0);
+
+	FGrassVariety Variety;
+	// 4 instances per quad of a square meter
+	Variety.Density = 400.0f;
+	Variety.Scaling = EGrassScaling::Free;
+	Variety.ScaleX = FFloatInterval(0.8f, 1.2f);
+	Variety.ScaleY = FFloatInterval(0.8f, 1.2f);
+	Variety.ScaleZ = FFloatInterval(0.5f, 1.5f);
+
+	for (const int32 GridSize : GridSizes)
+	{
+		FVertexGrid Grid;
+		Grid.Resolution = FIntPoint(GridSize);
+		Grid.VertexDistance = QuadSideLength;
+		Grid.UVIncrement = 1.0f / GridSize;
+		Grid.UV1Scale = FVector2D(0.125f);
+		Grid.HeightOffset = -1000.0f;
+		const int32 VertexAmount = Grid.GetVertexAmount();
+
+		TArray<float> Heights;
+		TArray<bool> VerticesInHole;
+		TArray<FVector2D> Locations;
+		TArray<FVector> Normals;
+		TArray<float> Weights;
+		Heights.SetNumUninitialized(VertexAmount);
+		VerticesInHole.SetNumUninitialized(VertexAmount);
+		Locations.SetNumUninitialized(VertexAmount);
+		Normals.SetNumUninitialized(VertexAmount);
+		Weights.SetNumUninitialized(VertexAmount);
+		for (int32 VertexIndex = 0; VertexIndex < VertexAmount; ++VertexIndex)
+		{
+			Heights[VertexIndex] = Random.FRandRange(0.0f, 2000.0f);
+			VerticesInHole[VertexIndex] = Random.GetFraction() < 0.05f;
+			Locations[VertexIndex] = FVector2D(VertexIndex % (GridSize + 1), VertexIndex / (GridSize + 1)) *
+				QuadSideLength;
+			Normals[VertexIndex] = FVector(Random.FRandRange(-0.3f, 0.3f), Random.FRandRange(-0.3f, 0.3f), 1.0f).
+				GetSafeNormal();
+			Weights[VertexIndex] = Random.GetFraction();
+		}
+
+		TArray<FVector> Vertices;
+		TArray<FVector2D> UV0;
+		TArray<FVector2D> UV1;
+		Vertices.SetNumUninitialized(VertexAmount);
+		UV0.SetNumUninitialized(VertexAmount);
+		UV1.SetNumUninitialized(VertexAmount);
+		MeasureKernel(*this, TEXT("GenerateVertices"), GridSize, VertexAmount, [&]()
+		{
+			GenerateVertices(Grid, Heights, Vertices, UV0, UV1);
+		});
+
+		TArray<int32> Triangles;
+		Triangles.SetNumUninitialized(Grid.GetTriangleIndexAmount());
+		int32 TriangleIndexAmount = 0;
+		MeasureKernel(*this, TEXT("GenerateTriangles"), GridSize, VertexAmount, [&]()
+		{
+			TriangleIndexAmount = GenerateTriangles(Grid, {}, Triangles);
+		});
+		TestEqual(TEXT("Triangle indices without holes"), TriangleIndexAmount, Grid.GetTriangleIndexAmount());
+
+		MeasureKernel(*this, TEXT("GenerateTrianglesHoles"), GridSize, VertexAmount, [&]()
+		{
+			TriangleIndexAmount = GenerateTriangles(Grid, VerticesInHole, Triangles);
+		});
+		TestTrue(TEXT("Holes remove triangles"), TriangleIndexAmount < Grid.GetTriangleIndexAmount());
+
+		// the layers cover the center of the grid, so every branch of the smoothing is taken
+		const FVector2D Center = FVector2D(GridSize * QuadSideLength * 0.5f);
+		const float Radius = GridSize * QuadSideLength * 0.25f;
+		const float SmoothingDistance = Radius * 0.5f;
+		TArray<float> SmoothingFactors;
+		SmoothingFactors.SetNumUninitialized(VertexAmount);
+		const FTransform LayerTransform(FRotator(0.0f, 30.0f, 0.0f), FVector(Center, 0.0f));
+		const FBox2D InnerBox(Center - Radius + SmoothingDistance, Center + Radius - SmoothingDistance);
+		MeasureKernel(*this, TEXT("BoxSmoothing"), GridSize, VertexAmount, [&]()
+		{
+			// the layer component rotates every location into the space of the layer
+			const FVector2D Origin(LayerTransform.GetLocation());
+			for (int32 VertexIndex = 0; VertexIndex < VertexAmount; ++VertexIndex)
+			{
+				const FVector RotatedLocation = LayerTransform.InverseTransformPosition(
+					FVector(Locations[VertexIndex], 0.0f));
+				float SmoothingFactor;
+				SmoothingFactors[VertexIndex] = TryCalculateBoxSmoothingFactor(
+					                                InnerBox, SmoothingDistance, FVector2D(RotatedLocation) + Origin,
+					                                SmoothingFactor)
+					                                ? SmoothingFactor
+					                                : -1.0f;
+			}
+		});
+
+		MeasureKernel(*this, TEXT("RoundSmoothing"), GridSize, VertexAmount, [&]()
+		{
+			for (int32 VertexIndex = 0; VertexIndex < VertexAmount; ++VertexIndex)
+			{
+				float SmoothingFactor;
+				SmoothingFactors[VertexIndex] = TryCalculateRoundSmoothingFactor(
+					                                Center, Radius, SmoothingDistance, 0.0f, SmoothingDistance,
+					                                Locations[VertexIndex], SmoothingFactor)
+					                                ? SmoothingFactor
+					                                : -1.0f;
+			}
+		});
+
+		TArray<FTransform> GrassTransforms;
+		int32 GrassInstanceAmount = 0;
+		MeasureKernel(*this, TEXT("PlaceGrass"), GridSize, VertexAmount, [&]()
+		{
+			// keep the allocation, so only the placement is measured
+			GrassTransforms.Reset();
+			for (int32 VertexIndex = 0; VertexIndex < VertexAmount; ++VertexIndex)
+			{
+				// seeded like the grass worker from the grass seed, the component index and the vertex index
+				uint32 Seed = GetTypeHash(GrassSeed);
+				Seed = HashCombine(Seed, GetTypeHash(ComponentIndex));
+				Seed = HashCombine(Seed, GetTypeHash(VertexIndex));
+				FRandomStream RandomStream(static_cast<int32>(Seed));
+
+				const int32 InstanceAmount = GetGrassInstanceAmount(Variety, FMath::Square(QuadSideLength),
+				                                                    Weights[VertexIndex], RandomStream);
+				if (InstanceAmount < 1)
+				{
+					continue;
+				}
+
+				const FQuat SurfaceAlignment = FQuat::FindBetweenNormals(FVector::UpVector, Normals[VertexIndex]);
+				const int32 FirstInstance = GrassTransforms.AddUninitialized(InstanceAmount);
+				PlaceGrassInstances(Variety, Vertices[VertexIndex], SurfaceAlignment, QuadSideLength, RandomStream,
+				                    MakeArrayView(GrassTransforms).Slice(FirstInstance, InstanceAmount));
+			}
+			GrassInstanceAmount = GrassTransforms.Num();
+		});
+		TestTrue(TEXT("Grass is placed"), GrassInstanceAmount > 0);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,175 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/Interval.h"
+
+/**
+ * The math of the landscape rebuild on plain data
+ * Grids are stored in row order with (Resolution + 1) vertices in each direction
+ * Outputs are written to views that have to be sized by the caller, so the kernels do not allocate
+ */
+namespace RuntimeLandscapeKernels
+{
+	/** Describes the vertex grid of a single component */
+	struct FVertexGrid
+	{
+		/** The amount of quads in each direction */
+		FIntPoint Resolution = FIntPoint::ZeroValue;
+		float VertexDistance = 0.0f;
+		float UVIncrement = 0.0f;
+		FVector2D UV1Scale = FVector2D::UnitVector;
+		FVector2D UV1Offset = FVector2D::ZeroVector;
+		/** Added to every height, i.e. to make the heights relative to the component */
+		float HeightOffset = 0.0f;
+
+		FORCEINLINE int32 GetVertexAmount() const { return (Resolution.X + 1) * (Resolution.Y + 1); }
+		/** The amount of triangle indices of the grid without holes */
+		FORCEINLINE int32 GetTriangleIndexAmount() const { return Resolution.X * Resolution.Y * 6; }
+	};
+
+	/**
+	 * Generate the vertex locations relative to the component and the uvs
+	 * @param Grid			The grid of the component
+	 * @param Heights		The height of every vertex
+	 * @param OutVertices	Receives the location of every vertex
+	 * @param OutUV0		Receives the uv of every vertex
+	 * @param OutUV1		Receives the uv of every vertex scaled and offset to the landscape
+	 */
+	RUNTIMEEDITABLELANDSCAPEKERNELS_API void GenerateVertices(const FVertexGrid& Grid, TConstArrayView<float> Heights,
+	                                                          TArrayView<FVector> OutVertices,
+	                                                          TArrayView<FVector2D> OutUV0,
+	                                                          TArrayView<FVector2D> OutUV1);
+
+	/**
+	 * Generate two triangles for every quad that has no vertex in a hole
+	 * @param Grid				The grid of the component
+	 * @param VerticesInHole	Whether each vertex is in a hole, empty if the grid has no holes
+	 * @param OutTriangles		Receives the triangle indices, must hold Grid.GetTriangleIndexAmount() entries
+	 * @return The amount of written triangle indices
+	 */
+	RUNTIMEEDITABLELANDSCAPEKERNELS_API int32 GenerateTriangles(const FVertexGrid& Grid,
+	                                                            TConstArrayView<bool> VerticesInHole,
+	                                                            TArrayView<int32> OutTriangles);
+
+	/**
+	 * Calculate the smoothing factor of a location in a box layer
+	 * @param InnerBox				The area without smoothing in the unrotated space of the layer
+	 * @param SmoothingDistance		The distance in which the layer fades out
+	 * @param Location				The location in the unrotated space of the layer
+	 * @param OutSmoothingFactor	0 inside the inner box, 1 at the smoothing distance
+	 * @return false if the location is not affected
+	 */
+	FORCEINLINE bool TryCalculateBoxSmoothingFactor(const FBox2D& InnerBox, float SmoothingDistance,
+	                                                const FVector2D& Location, float& OutSmoothingFactor)
+	{
+		const float DistanceSqr = InnerBox.ComputeSquaredDistanceToPoint(Location);
+		const float SmoothingDistanceSqr = FMath::Square(SmoothingDistance);
+		if (DistanceSqr >= SmoothingDistanceSqr)
+		{
+			return false;
+		}
+
+		OutSmoothingFactor = DistanceSqr == 0.0f ? 0.0f : DistanceSqr / SmoothingDistanceSqr;
+		return true;
+	}
+
+	/**
+	 * Calculate the smoothing factor of a location in a round layer
+	 * @param Origin				The center of the layer
+	 * @param Radius				The radius of the layer
+	 * @param InnerOffset			The part of the smoothing that is inside of the radius
+	 * @param OuterOffset			The part of the smoothing that is outside of the radius
+	 * @param SmoothingDistance		The distance in which the layer fades out
+	 * @param Location				The location
+	 * @param OutSmoothingFactor	0 inside the inner radius, 1 at the outer radius
+	 * @return false if the location is not affected
+	 */
+	FORCEINLINE bool TryCalculateRoundSmoothingFactor(const FVector2D& Origin, float Radius, float InnerOffset,
+	                                                  float OuterOffset, float SmoothingDistance,
+	                                                  const FVector2D& Location, float& OutSmoothingFactor)
+	{
+		const float OuterRadiusSquared = FMath::Square(Radius + OuterOffset);
+		const float DistanceSqr = (Location - Origin).SizeSquared();
+		if (DistanceSqr >= OuterRadiusSquared)
+		{
+			return false;
+		}
+
+		const float InnerRadiusSqr = FMath::Square(Radius - InnerOffset);
+		if (DistanceSqr < InnerRadiusSqr)
+		{
+			OutSmoothingFactor = 0.0f;
+		}
+		else
+		{
+			check(SmoothingDistance > 0.0f);
+			const float Distance = FMath::Abs(FMath::Sqrt(DistanceSqr) - (Radius - InnerOffset));
+			OutSmoothingFactor = Distance / SmoothingDistance;
+			check(OutSmoothingFactor >= 0.0f && OutSmoothingFactor <= 1.0f);
+		}
+
+		return true;
+	}
+
+	/** Mirrors EGrassScaling, which is not available without the engine */
+	enum class EGrassScaling : uint8
+	{
+		Uniform,
+		Free,
+		LockXY
+	};
+
+	/** The placement settings of a grass variety */
+	struct FGrassVariety
+	{
+		/** Instances per 10 square meters */
+		float Density = 0.0f;
+		bool bRandomRotation = true;
+		EGrassScaling Scaling = EGrassScaling::Uniform;
+		FFloatInterval ScaleX = FFloatInterval(1.0f, 1.0f);
+		FFloatInterval ScaleY = FFloatInterval(1.0f, 1.0f);
+		FFloatInterval ScaleZ = FFloatInterval(1.0f, 1.0f);
+
+		/** Hash every placement setting, the hash is the same across sessions */
+		friend FORCEINLINE uint32 GetTypeHash(const FGrassVariety& Variety)
+		{
+			uint32 Result = GetTypeHash(Variety.Density);
+			Result = HashCombine(Result, GetTypeHash(Variety.bRandomRotation));
+			Result = HashCombine(Result, GetTypeHash(static_cast<uint8>(Variety.Scaling)));
+			for (const FFloatInterval& Scale : {Variety.ScaleX, Variety.ScaleY, Variety.ScaleZ})
+			{
+				Result = HashCombine(Result, GetTypeHash(Scale.Min));
+				Result = HashCombine(Result, GetTypeHash(Scale.Max));
+			}
+
+			return Result;
+		}
+	};
+
+	/**
+	 * Get the amount of instances of a grass variety at a vertex, the fraction is rounded randomly
+	 * The random stream is advanced in a fixed order, so the same stream always places the same instances
+	 * @param Variety			The grass variety
+	 * @param AreaPerSquare		The area of a quad
+	 * @param Weight			Scales the density
+	 * @param RandomStream		The random stream of the vertex
+	 */
+	RUNTIMEEDITABLELANDSCAPEKERNELS_API int32 GetGrassInstanceAmount(const FGrassVariety& Variety, float AreaPerSquare,
+	                                                                 float Weight, FRandomStream& RandomStream);
+	/**
+	 * Place instances of a grass variety in the quad around a vertex
+	 * @param Variety			The grass variety
+	 * @param VertexLocation	The location of the vertex
+	 * @param SurfaceAlignment	The rotation from the up vector to the vertex normal
+	 * @param QuadSideLength	The side length of a quad
+	 * @param RandomStream		The random stream of the vertex, after GetGrassInstanceAmount
+	 * @param OutTransforms		Receives one instance per entry
+	 */
+	RUNTIMEEDITABLELANDSCAPEKERNELS_API void PlaceGrassInstances(const FGrassVariety& Variety,
+	                                                             const FVector& VertexLocation,
+	                                                             const FQuat& SurfaceAlignment, float QuadSideLength,
+	                                                             FRandomStream& RandomStream,
+	                                                             TArrayView<FTransform> OutTransforms);
+}